@@ -0,0 +1,12 @@
+#pragma once
+
+// To be included only via other tuc headers
+
+#if defined(__GNUC__) && __GNUC__ < 11
+#define TUC_HAS_EXECUTION_POLICY 0
+#elif __cplusplus >= 201703L || (defined (_MSC_VER) && _HAS_CXX17)
+#define TUC_HAS_EXECUTION_POLICY 1
+#include <execution>
+#else // C++17
+#define TUC_HAS_EXECUTION_POLICY 0
+#endif // C++17
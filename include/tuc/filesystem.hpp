@@ -2,6 +2,10 @@
 
 #if defined(WIN32) || defined(__APPLE__)
 // no need to use "experimental" filesystem
+#elif defined(__has_include)
+#if !__has_include(<filesystem>)
+#define TUC_USE_EXPERIMENTAL_FILESYSTEM
+#endif
 #else
 #define TUC_USE_EXPERIMENTAL_FILESYSTEM
 #endif
@@ -12,6 +16,23 @@
 #include <filesystem>
 #endif
 
+#include "shared_queue.hpp"
+#include "thread_pool.hpp"
+#include <atomic>
+#include <cstdint>
+#include <exception>
+#include <fstream>
+#include <functional>
+#include <future>
+#include <limits>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <system_error>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
 namespace tuc
 { 
 #ifdef TUC_USE_EXPERIMENTAL_FILESYSTEM
@@ -20,14 +41,746 @@ namespace tuc
     namespace fs = std::filesystem;
 #endif
 
-    inline void remove_empty_directories_recursively(fs::path const& path) {
-        for (fs::directory_iterator i(path), end; i != end; ++i) {
-            if (fs::is_directory(i->path())) {
-                remove_empty_directories_recursively(i->path());
+    enum struct filesystem_error_policy
+    {
+        throw_exception, // fs::filesystem_error
+        skip // leave the entries that cannot be read or removed, and continue with the others
+    };
+
+    namespace filesystem_detail
+    {
+        // Returns the type of the entry, or optionally of the file a symbolic link points to (or
+        // fs::file_type::symlink, if there is none). std::filesystem caches the type that the
+        // directory listing returns, so usually this needs no extra stat.
+        inline fs::file_type get_type(fs::directory_entry const& entry, bool follow_symlinks, std::error_code& ec)
+        {
+            auto const get_target_type = [&entry, &ec]() {
+                fs::file_type const type = fs::status(entry.path(), ec).type();
+                if (type == fs::file_type::not_found) {
+                    ec.clear();
+                    return fs::file_type::symlink; // broken
+                }
+                return type;
+            };
+#ifdef TUC_USE_EXPERIMENTAL_FILESYSTEM
+            fs::file_type const type = entry.symlink_status(ec).type();
+            return type == fs::file_type::symlink && follow_symlinks ? get_target_type() : type;
+#else
+            if (entry.is_symlink(ec)) {
+                return follow_symlinks ? get_target_type() : fs::file_type::symlink;
+            }
+            if (ec) {
+                return fs::file_type::none;
+            }
+            if (entry.is_directory(ec)) {
+                return fs::file_type::directory;
+            }
+            if (entry.is_regular_file(ec)) {
+                return fs::file_type::regular;
+            }
+            return ec ? fs::file_type::none : entry.symlink_status(ec).type(); // the rare other types
+#endif
+        }
+
+        // Returns true if the directory was empty (apart from empty subdirectories) and removed.
+        // The emptiness is tracked while listing, so that the directory needs not be read again.
+        inline bool remove_if_empty(fs::path const& path, filesystem_error_policy error_policy, size_t& removed_count)
+        {
+            bool empty = true;
+            std::error_code ec;
+            for (fs::directory_iterator i(path, ec), end; !ec && i != end; i.increment(ec)) {
+                bool const is_subdirectory = get_type(*i, false, ec) == fs::file_type::directory;
+                if (ec) {
+                    break;
+                }
+                if (!is_subdirectory || !remove_if_empty(i->path(), error_policy, removed_count)) {
+                    empty = false;
+                }
+            }
+            if (!ec && empty) {
+                fs::remove(path, ec);
+            }
+            if (ec) {
+                if (error_policy == filesystem_error_policy::throw_exception) {
+                    throw fs::filesystem_error("tuc::remove_empty_directories_recursively", path, ec);
+                }
+                return false;
+            }
+            if (empty) {
+                ++removed_count;
+            }
+            return empty;
+        }
+
+        // Each directory is listed in its own task. When the last of its subdirectories is done, it
+        // is removed if it is empty, and its parent is notified in turn. The tasks share the
+        // ownership of the remover, which may outlive run() a little.
+        class parallel_empty_directory_remover : public std::enable_shared_from_this<parallel_empty_directory_remover>
+        {
+        public:
+            parallel_empty_directory_remover(thread_pool& tp, filesystem_error_policy error_policy)
+                : tp(tp)
+                , error_policy(error_policy)
+            {}
+
+            size_t run(fs::path const& root)
+            {
+                process(std::make_shared<directory>(root, nullptr));
+                done.get_future().wait();
+                if (error) {
+                    std::rethrow_exception(error);
+                }
+                return removed_count;
+            }
+
+        private:
+            struct directory
+            {
+                directory(fs::path path, std::shared_ptr<directory> parent)
+                    : path(std::move(path))
+                    , parent(std::move(parent))
+                {}
+
+                fs::path const path;
+                std::shared_ptr<directory> const parent;
+                std::atomic<size_t> pending_count{ 1 }; // the listing, and each subdirectory
+                std::atomic<bool> empty{ true };
+            };
+
+            void process(std::shared_ptr<directory> const& d)
+            {
+                try {
+                    list(d);
+                }
+                catch (...) { // e.g., std::bad_alloc
+                    d->empty = false;
+                    set_error(std::current_exception());
+                }
+                finish(d);
+            }
+
+            void list(std::shared_ptr<directory> const& d)
+            {
+                std::vector<fs::path> subdirectories;
+                std::error_code ec;
+                if (!cancelled) {
+                    for (fs::directory_iterator i(d->path, ec), end; !ec && i != end; i.increment(ec)) {
+                        bool const is_subdirectory = get_type(*i, false, ec) == fs::file_type::directory;
+                        if (ec) {
+                            break;
+                        }
+                        if (is_subdirectory) {
+                            subdirectories.push_back(i->path());
+                        }
+                        else {
+                            d->empty = false;
+                        }
+                    }
+                }
+                if (ec) {
+                    d->empty = false;
+                    on_error(d->path, ec);
+                }
+                for (auto& subdirectory : subdirectories) {
+                    auto child = std::make_shared<directory>(std::move(subdirectory), d);
+                    ++d->pending_count; // before the child may finish
+                    try {
+                        tp([self = shared_from_this(), child]() { self->process(child); });
+                    }
+                    catch (...) {
+                        --d->pending_count; // the child never runs
+                        throw;
+                    }
+                }
+            }
+
+            void finish(std::shared_ptr<directory> const& d)
+            {
+                if (--d->pending_count > 0) {
+                    return;
+                }
+                bool removed = false;
+                if (d->empty && !cancelled) {
+                    std::error_code ec;
+                    fs::remove(d->path, ec);
+                    if (ec) {
+                        on_error(d->path, ec);
+                    }
+                    else {
+                        removed = true;
+                        ++removed_count;
+                    }
+                }
+                if (d->parent) {
+                    if (!removed) {
+                        d->parent->empty = false;
+                    }
+                    finish(d->parent);
+                }
+                else {
+                    done.set_value();
+                }
+            }
+
+            void on_error(fs::path const& path, std::error_code const& ec)
+            {
+                if (error_policy == filesystem_error_policy::skip) {
+                    return;
+                }
+                try {
+                    throw fs::filesystem_error("tuc::remove_empty_directories_recursively", path, ec);
+                }
+                catch (...) { // also if constructing the error fails
+                    set_error(std::current_exception());
+                }
+            }
+
+            void set_error(std::exception_ptr e)
+            {
+                std::lock_guard<std::mutex> lock(error_mutex);
+                if (!error) {
+                    error = e;
+                    cancelled = true; // finish quickly, without removing anything more
+                }
+            }
+
+            thread_pool& tp;
+            filesystem_error_policy const error_policy;
+            std::atomic<size_t> removed_count{ 0 };
+            std::atomic<bool> cancelled{ false };
+            std::mutex error_mutex;
+            std::exception_ptr error;
+            std::promise<void> done;
+        };
+    }
+
+    struct walk_entry
+    {
+        fs::path path;
+        fs::file_type type = fs::file_type::none; // of the entry itself, unless symbolic links are followed
+        size_t depth = 0; // 0 for the entries directly in the root
+
+        // Only with walk_options::fetch_status
+        uintmax_t size = 0; // of regular files
+        fs::file_time_type last_write_time = fs::file_time_type::min(); // not of symbolic links themselves
+    };
+
+    struct walk_options
+    {
+        size_t max_depth = std::numeric_limits<size_t>::max(); // the deepest level to list (0 for just the root)
+        bool follow_symlinks = false; // descend into the directories they point to (but not back into an ancestor)
+        bool fetch_status = false; // the size and last write time, which take extra stats
+
+        // Excluded entries are neither returned nor (if directories) descended into. The status is not
+        // fetched yet for exclude.
+        std::function<bool(walk_entry const&)> include; // all, if empty
+        std::function<bool(walk_entry const&)> exclude; // none, if empty
+
+        filesystem_error_policy error_policy = filesystem_error_policy::throw_exception;
+    };
+
+    namespace filesystem_detail
+    {
+        // Runs a task for each directory of a tree: in a thread pool, or without one, from a stack in
+        // the calling thread. The first error (or exception) cancels the rest.
+        class directory_tasks : public std::enable_shared_from_this<directory_tasks>
+        {
+        public:
+            virtual ~directory_tasks() = default;
+
+            // In the calling thread
+            void run(fs::path const& root)
+            {
+                stack.emplace_back(root, 0);
+                while (!stack.empty()) {
+                    auto directory = std::move(stack.back());
+                    stack.pop_back();
+                    execute(directory.first, directory.second);
+                }
+                if (error) {
+                    std::rethrow_exception(error);
+                }
+            }
+
+            // In the thread pool; the future is ready when all the tasks have finished
+            std::future<void> start(fs::path const& root, std::function<void()> on_done = {})
+            {
+                this->on_done = std::move(on_done);
+                auto future = done.get_future();
+                spawn(root, 0);
+                return future;
+            }
+
+        protected:
+            directory_tasks(char const* name, filesystem_error_policy error_policy, thread_pool* tp)
+                : name(name)
+                , error_policy(error_policy)
+                , tp(tp)
+            {}
+
+            // Processes the directory at the depth (0 for the root), spawning tasks for its subdirectories
+            virtual void process(fs::path const& directory, size_t depth) = 0;
+
+            void spawn(fs::path const& directory, size_t depth)
+            {
+                if (!tp) {
+                    stack.emplace_back(directory, depth);
+                    return;
+                }
+                ++pending_count; // before the task may finish
+                try {
+                    (*tp)([self = shared_from_this(), directory, depth]() {
+                        self->execute(directory, depth);
+                        self->finish();
+                    });
+                }
+                catch (...) {
+                    --pending_count; // the task never runs
+                    throw;
+                }
+            }
+
+            bool is_cancelled() const
+            {
+                return cancelled;
+            }
+
+            void on_error(fs::path const& path, std::error_code const& ec)
+            {
+                if (error_policy == filesystem_error_policy::throw_exception) {
+                    set_error(std::make_exception_ptr(fs::filesystem_error(name, path, ec)));
+                }
+            }
+
+            mutable std::mutex mutex; // for the derived classes, too
+
+        private:
+            void execute(fs::path const& directory, size_t depth)
+            {
+                if (cancelled) {
+                    return;
+                }
+                try {
+                    process(directory, depth);
+                }
+                catch (...) { // e.g., from callbacks
+                    set_error(std::current_exception());
+                }
+            }
+
+            void set_error(std::exception_ptr e)
+            {
+                std::lock_guard<std::mutex> lock(mutex);
+                if (!error) {
+                    error = e;
+                    cancelled = true;
+                }
+            }
+
+            void finish()
+            {
+                if (--pending_count > 0) {
+                    return;
+                }
+                if (on_done) {
+                    on_done();
+                }
+                if (error) {
+                    done.set_exception(std::move(error)); // only the caller holds it from now on
+                }
+                else {
+                    done.set_value();
+                }
+            }
+
+            char const* const name;
+            filesystem_error_policy const error_policy;
+            thread_pool* const tp;
+            std::vector<std::pair<fs::path, size_t>> stack;
+            std::atomic<size_t> pending_count{ 0 };
+            std::atomic<bool> cancelled{ false };
+            std::exception_ptr error;
+            std::function<void()> on_done;
+            std::promise<void> done;
+        };
+
+        // Returns the entries as they are found
+        class walker : public directory_tasks
+        {
+        public:
+            walker(walk_options const& options, std::function<void(walk_entry&&)> found, thread_pool* tp)
+                : directory_tasks("tuc::walk", options.error_policy, tp)
+                , options(options)
+                , found(std::move(found))
+            {}
+
+        private:
+            void process(fs::path const& directory, size_t depth) override
+            {
+                std::error_code ec;
+                for (fs::directory_iterator i(directory, ec), end; !ec && i != end && !is_cancelled(); i.increment(ec)) {
+                    walk_entry entry;
+                    entry.path = i->path();
+                    entry.depth = depth;
+                    entry.type = get_type(*i, options.follow_symlinks, ec);
+                    if (ec) {
+                        on_error(entry.path, ec);
+                        ec.clear();
+                        continue;
+                    }
+                    if (options.exclude && options.exclude(entry)) {
+                        continue;
+                    }
+                    bool const descend = entry.type == fs::file_type::directory && depth < options.max_depth && !is_cycle(*i, directory, depth);
+                    if (options.fetch_status) {
+                        fetch_status(entry);
+                    }
+                    if (descend) {
+                        spawn(entry.path, depth + 1);
+                    }
+                    if (!options.include || options.include(entry)) {
+                        found(std::move(entry));
+                    }
+                }
+                if (ec) {
+                    on_error(directory, ec);
+                }
+            }
+
+            // fs::last_write_time follows symbolic links, so entries that are still of that type (not
+            // followed, or broken) are left without a time rather than failing
+            void fetch_status(walk_entry& entry)
+            {
+                std::error_code ec;
+                if (entry.type == fs::file_type::regular) {
+                    entry.size = fs::file_size(entry.path, ec);
+                }
+                if (!ec && entry.type != fs::file_type::symlink) {
+                    entry.last_write_time = fs::last_write_time(entry.path, ec);
+                }
+                if (ec) {
+                    on_error(entry.path, ec);
+                }
             }
+
+            // Following a symbolic link to the directory being listed, or to any of its ancestors up
+            // to the root, would list them all over again. The ancestors are compared by what their
+            // (possibly linked) paths refer to, i.e., device and inode.
+            bool is_cycle(fs::directory_entry const& entry, fs::path ancestor, size_t depth) const
+            {
+                std::error_code ec;
+                if (!options.follow_symlinks || entry.symlink_status(ec).type() != fs::file_type::symlink) {
+                    return false;
+                }
+                for (size_t i = 0; i <= depth; ++i, ancestor = ancestor.parent_path()) {
+                    if (fs::equivalent(entry.path(), ancestor, ec) || ec) {
+                        return true;
+                    }
+                }
+                return false;
+            }
+
+            walk_options const options;
+            std::function<void(walk_entry&&)> const found;
+        };
+    }
+
+    // Lists the entries under root recursively (without root itself), in the calling thread
+    inline void walk(fs::path const& root, walk_options const& options, std::function<void(walk_entry&&)> found)
+    {
+        std::make_shared<filesystem_detail::walker>(options, std::move(found), nullptr)->run(root);
+    }
+
+    // Lists the directories in parallel, calling found concurrently from the threads of the pool.
+    // Returns when done. Must not be called from a task running in the same pool.
+    inline void walk(fs::path const& root, thread_pool& tp, walk_options const& options, std::function<void(walk_entry&&)> found)
+    {
+        std::make_shared<filesystem_detail::walker>(options, std::move(found), &tp)->start(root).get();
+    }
+
+    // Streams the entries into the queue, so that they can be processed while the listing goes on.
+    // Returns immediately: the future is ready (or holds the error) when all the entries have been
+    // pushed, and then the queue is halted, to wake up the consumers.
+    inline std::future<void> walk(fs::path const& root, thread_pool& tp, walk_options const& options, shared_queue<walk_entry>& queue)
+    {
+        auto const push = [&queue](walk_entry&& entry) { queue.push_back(std::move(entry)); };
+        return std::make_shared<filesystem_detail::walker>(options, push, &tp)->start(root, [&queue]() { queue.halt(); });
+    }
+
+    // Removes the directory, if it contains nothing but (recursively) empty directories, and else
+    // all the empty directories in it. Symbolic links are not followed. Returns the number of
+    // directories removed.
+    inline size_t remove_empty_directories_recursively(fs::path const& path, filesystem_error_policy error_policy = filesystem_error_policy::throw_exception)
+    {
+        size_t removed_count = 0;
+        filesystem_detail::remove_if_empty(path, error_policy, removed_count);
+        return removed_count;
+    }
+
+    // Processes the subtrees in parallel. Must not be called from a task running in the same pool.
+    inline size_t remove_empty_directories_recursively(fs::path const& path, thread_pool& tp, filesystem_error_policy error_policy = filesystem_error_policy::throw_exception)
+    {
+        return std::make_shared<filesystem_detail::parallel_empty_directory_remover>(tp, error_policy)->run(path);
+    }
+
+    struct disk_usage_info
+    {
+        uintmax_t size = 0; // the sum of the (apparent) sizes of the regular files; hard links count each time
+        size_t file_count = 0; // regular files
+        size_t directory_count = 0; // including the root
+    };
+
+    namespace filesystem_detail
+    {
+        class disk_usage_scanner;
+    }
+
+    // The totals of the files directly in each directory, keyed by the directory's last write time,
+    // so that repeated disk_usage scans of the same root need not list (nor stat the files of) the
+    // directories that have not changed since; each directory still takes one stat. Like git with
+    // its index, a directory is only trusted if its time is older than the start of the scan that
+    // cached it, since a change during that scan may have left the time as it was. Note that files
+    // modified in place (rather than replaced) do not touch the time of their directory, so their
+    // sizes may get stale: clear the cache every now and then if that matters.
+    class disk_usage_cache
+    {
+    public:
+        // Returns false, leaving the cache empty, if the file does not exist or is not a valid cache
+        bool load(fs::path const& path)
+        {
+            clear();
+            std::ifstream in(path, std::ios::binary);
+            std::string header;
+            if (!std::getline(in, header) || header != file_header || !read(in, scan_time)) {
+                clear();
+                return false;
+            }
+            std::string key;
+            directory totals;
+            while (in.peek() != std::ifstream::traits_type::eof()) {
+                uint64_t subdirectory_count = 0;
+                if (!read(in, key) || !read(in, totals.last_write_time) || !read(in, totals.size) || !read(in, totals.file_count) || !read(in, subdirectory_count)) {
+                    clear();
+                    return false;
+                }
+                totals.subdirectories.clear();
+                for (uint64_t i = 0; i < subdirectory_count; ++i) {
+                    std::string subdirectory;
+                    if (!read(in, subdirectory)) {
+                        clear();
+                        return false;
+                    }
+                    totals.subdirectories.push_back(std::move(subdirectory));
+                }
+                directories[key] = std::move(totals);
+            }
+            return true;
         }
-        if (fs::is_empty(path)) {
-            fs::remove(path);
+
+        // In the byte order of the machine. Throws fs::filesystem_error.
+        void save(fs::path const& path) const
+        {
+            std::ofstream out(path, std::ios::binary | std::ios::trunc);
+            out << file_header << '\n';
+            write(out, scan_time);
+            for (auto const& i : directories) {
+                write(out, i.first);
+                write(out, i.second.last_write_time);
+                write(out, i.second.size);
+                write(out, i.second.file_count);
+                write(out, static_cast<uint64_t>(i.second.subdirectories.size()));
+                for (auto const& subdirectory : i.second.subdirectories) {
+                    write(out, subdirectory);
+                }
+            }
+            out.close();
+            if (!out) {
+                throw fs::filesystem_error("tuc::disk_usage_cache", path, std::make_error_code(std::errc::io_error));
+            }
+        }
+
+        // The number of directories
+        size_t get_size() const
+        {
+            return directories.size();
+        }
+
+        void clear()
+        {
+            directories.clear();
+            scan_time = std::numeric_limits<int64_t>::min();
         }
+
+    private:
+        friend class filesystem_detail::disk_usage_scanner;
+
+        struct directory
+        {
+            int64_t last_write_time = 0;
+            uint64_t size = 0;
+            uint64_t file_count = 0;
+            std::vector<std::string> subdirectories; // the names, as UTF-8
+        };
+
+        template <typename T>
+        static bool read(std::istream& in, T& value)
+        {
+            return static_cast<bool>(in.read(reinterpret_cast<char*>(&value), sizeof(value)));
+        }
+
+        static bool read(std::istream& in, std::string& value)
+        {
+            uint64_t length = 0;
+            if (!read(in, length) || length > (1u << 20)) {
+                return false;
+            }
+            value.resize(static_cast<size_t>(length));
+            return static_cast<bool>(in.read(&value[0], static_cast<std::streamsize>(length)));
+        }
+
+        template <typename T>
+        static void write(std::ostream& out, T value)
+        {
+            out.write(reinterpret_cast<char const*>(&value), sizeof(value));
+        }
+
+        static void write(std::ostream& out, std::string const& value)
+        {
+            write(out, static_cast<uint64_t>(value.length()));
+            out.write(value.data(), static_cast<std::streamsize>(value.length()));
+        }
+
+        static constexpr char const* file_header = "tuc::disk_usage_cache 2";
+
+        std::unordered_map<std::string, directory> directories; // by the absolute path, as UTF-8
+        int64_t scan_time = std::numeric_limits<int64_t>::min(); // when the scan that filled it started
+    };
+
+    namespace filesystem_detail
+    {
+        // Reads the cache, and collects what it finds for replacing it
+        class disk_usage_scanner : public directory_tasks
+        {
+        public:
+            disk_usage_scanner(disk_usage_cache* cache, filesystem_error_policy error_policy, thread_pool* tp)
+                : directory_tasks("tuc::disk_usage", error_policy, tp)
+                , cache(cache)
+                , scan_time(static_cast<int64_t>(fs::file_time_type::clock::now().time_since_epoch().count()))
+            {}
+
+            disk_usage_info get_result()
+            {
+                if (cache) {
+                    cache->directories.swap(scanned);
+                    cache->scan_time = scan_time;
+                }
+                disk_usage_info result;
+                result.size = size;
+                result.file_count = file_count;
+                result.directory_count = directory_count;
+                return result;
+            }
+
+        private:
+            void process(fs::path const& directory, size_t depth) override
+            {
+                std::error_code ec;
+                int64_t const last_write_time = static_cast<int64_t>(fs::last_write_time(directory, ec).time_since_epoch().count());
+                if (ec) {
+                    on_error(directory, ec);
+                    return;
+                }
+                std::string key = directory.u8string();
+                disk_usage_cache::directory totals;
+                bool complete = true; // else the totals are not cached, so that they are not trusted later
+                disk_usage_cache::directory const* const cached = find_cached(key);
+                if (cached && cached->last_write_time == last_write_time && last_write_time < cache->scan_time) {
+                    totals = *cached;
+                }
+                else {
+                    totals.last_write_time = last_write_time;
+                    if (!list(directory, totals, complete)) {
+                        return;
+                    }
+                }
+                size += totals.size;
+                file_count += static_cast<size_t>(totals.file_count);
+                ++directory_count;
+                for (auto const& subdirectory : totals.subdirectories) {
+                    spawn(directory / fs::u8path(subdirectory), depth + 1);
+                }
+                if (cache && complete) {
+                    std::lock_guard<std::mutex> lock(mutex);
+                    scanned[std::move(key)] = std::move(totals);
+                }
+            }
+
+            disk_usage_cache::directory const* find_cached(std::string const& key) const
+            {
+                if (!cache) {
+                    return nullptr;
+                }
+                auto const i = cache->directories.find(key);
+                return i == cache->directories.end() ? nullptr : &i->second;
+            }
+
+            // Returns false if the directory cannot be listed, and clears complete if some entry cannot
+            // be read (which is skipped, depending on the error policy)
+            bool list(fs::path const& directory, disk_usage_cache::directory& totals, bool& complete)
+            {
+                std::error_code ec;
+                for (fs::directory_iterator i(directory, ec), end; !ec && i != end && !is_cancelled(); i.increment(ec)) {
+                    fs::file_type const type = get_type(*i, false, ec);
+                    if (!ec && type == fs::file_type::regular) {
+#ifdef TUC_USE_EXPERIMENTAL_FILESYSTEM
+                        uintmax_t const file_size = fs::file_size(i->path(), ec);
+#else
+                        uintmax_t const file_size = i->file_size(ec); // cached by the listing on Windows
+#endif
+                        if (!ec) {
+                            totals.size += file_size;
+                            ++totals.file_count;
+                        }
+                    }
+                    else if (!ec && type == fs::file_type::directory) {
+                        totals.subdirectories.push_back(i->path().filename().u8string());
+                    }
+                    if (ec) {
+                        complete = false;
+                        on_error(i->path(), ec);
+                        ec.clear();
+                    }
+                }
+                if (ec) {
+                    on_error(directory, ec);
+                    return false;
+                }
+                return true;
+            }
+
+            disk_usage_cache* const cache; // only read during the scan
+            int64_t const scan_time;
+            std::unordered_map<std::string, disk_usage_cache::directory> scanned;
+            std::atomic<uintmax_t> size{ 0 };
+            std::atomic<size_t> file_count{ 0 };
+            std::atomic<size_t> directory_count{ 0 };
+        };
+    }
+
+    // Sums up the sizes of the regular files under root (without following symbolic links). With a
+    // cache, replaces its contents with what was found; a cache is meant for one root at a time.
+    inline disk_usage_info disk_usage(fs::path const& root, disk_usage_cache* cache = nullptr, filesystem_error_policy error_policy = filesystem_error_policy::throw_exception)
+    {
+        auto const scanner = std::make_shared<filesystem_detail::disk_usage_scanner>(cache, error_policy, nullptr);
+        scanner->run(fs::absolute(root));
+        return scanner->get_result();
+    }
+
+    // Processes the directories in parallel. Must not be called from a task running in the same pool.
+    inline disk_usage_info disk_usage(fs::path const& root, thread_pool& tp, disk_usage_cache* cache = nullptr, filesystem_error_policy error_policy = filesystem_error_policy::throw_exception)
+    {
+        auto const scanner = std::make_shared<filesystem_detail::disk_usage_scanner>(cache, error_policy, &tp);
+        scanner->start(fs::absolute(root)).get();
+        return scanner->get_result();
     }
 }
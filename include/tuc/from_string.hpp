@@ -1,37 +1,77 @@
 #pragma once
 
-#include <string>
-#include <limits>
-
-#ifndef WIN32
-#include <assert.h>
-#endif // WIN32
+#include <algorithm>
+#include <charconv>
+#include <optional>
+#include <stdexcept>
+#include <string_view>
+#include <system_error>
+#include <vector>
+#include "from_string_detail.hpp"
 
 namespace tuc
 { 
+    // Parses an integral or floating-point number at the beginning of input (after any white space),
+    // without allocating or depending on the locale. Like std::from_chars, returns the end of the
+    // number, or an error (in which case value is not modified).
     template <typename T>
-    T from_string(std::string const& string)
+    std::from_chars_result from_string(std::string_view input, T& value)
     {
-        static_assert(std::is_floating_point<T>::value, "Floating-point type required"); // doesn't really make a lot of sense for other types
+        return from_string_detail::parse(input.data(), input.data() + input.length(), value);
+    }
 
-        if (string == std::to_string(std::numeric_limits<T>::quiet_NaN())) {
-            return std::numeric_limits<T>::quiet_NaN();
+    // Like std::stod, ignores anything after the number, and throws std::invalid_argument or
+    // std::out_of_range
+    template <typename T>
+    T from_string(std::string_view input)
+    {
+        T value = T();
+        auto const result = from_string(input, value);
+        if (result.ec == std::errc::invalid_argument) {
+            throw std::invalid_argument("tuc::from_string: not a number");
+        }
+        if (result.ec == std::errc::result_out_of_range) {
+            throw std::out_of_range("tuc::from_string: out of range");
         }
+        return value;
+    }
 
-#if __cplusplus >= 201703L
-        if constexpr (std::is_same<T, double>::value) {
-            return std::stod(string);
+    // Returns nothing unless input is a number, apart from any surrounding white space
+    template <typename T>
+    std::optional<T> try_from_string(std::string_view input)
+    {
+        T value = T();
+        auto const result = from_string(input, value);
+        char const* const last = input.data() + input.length();
+        if (result.ec != std::errc() || from_string_detail::skip_spaces(result.ptr, last) != last) {
+            return std::nullopt;
         }
-        if constexpr (std::is_same<T, float>::value) {
-            return std::stof(string);
+        return value;
+    }
+
+    // Parses the numbers separated by delimiter (e.g., '\n' for a column, or ',' for a CSV row),
+    // appending them to output. A trailing delimiter is ignored. Stops at the first field that is not
+    // a number (apart from any surrounding white space), and returns its position and the error; on
+    // success, returns the end of the input.
+    template <typename T>
+    std::from_chars_result from_delimited_string(std::string_view input, char delimiter, std::vector<T>& output)
+    {
+        char const* first = input.data();
+        char const* const last = first + input.length();
+        while (first != last) {
+            char const* const field_end = std::find(first, last, delimiter);
+            T value = T();
+            auto const result = from_string_detail::parse(first, field_end, value);
+            if (result.ec != std::errc()) {
+                return result;
+            }
+            char const* const end = from_string_detail::skip_spaces(result.ptr, field_end);
+            if (end != field_end) {
+                return { end, std::errc::invalid_argument };
+            }
+            output.push_back(value);
+            first = field_end == last ? last : field_end + 1;
         }
-#ifdef WIN32
-        static_assert(false, "Unexpected type");
-#else // WIN32
-        assert(false); // Unexpected type
-#endif // WIN32
-#else
-        return static_cast<T>(std::stod(string));
-#endif
+        return { last, std::errc() };
     }
 }
@@ -0,0 +1,117 @@
+#pragma once
+
+// To be included only via tuc/from_string.hpp
+
+#include <charconv>
+#include <type_traits>
+
+// std::from_chars for floating-point types needs, e.g., libstdc++ 11 (and libc++ has none yet)
+#if defined(__cpp_lib_to_chars)
+#define TUC_HAS_FLOATING_POINT_FROM_CHARS 1
+#else // __cpp_lib_to_chars
+#define TUC_HAS_FLOATING_POINT_FROM_CHARS 0
+#include <algorithm>
+#include <cerrno>
+#include <cstdlib>
+#include <string>
+#endif // __cpp_lib_to_chars
+
+namespace tuc
+{
+    namespace from_string_detail
+    {
+        inline bool is_space(char c)
+        {
+            return c == ' ' || c == '\t' || c == '\n' || c == '\r' || c == '\f' || c == '\v';
+        }
+
+        inline char const* skip_spaces(char const* first, char const* last)
+        {
+            while (first != last && is_space(*first)) {
+                ++first;
+            }
+            return first;
+        }
+
+        inline bool is_hex_digit(char c)
+        {
+            return (c >= '0' && c <= '9') || (c >= 'a' && c <= 'f') || (c >= 'A' && c <= 'F');
+        }
+
+#if TUC_HAS_FLOATING_POINT_FROM_CHARS
+        // Unlike strtod, from_chars does not take the "0x" prefix of hexadecimal numbers, so that is
+        // skipped here. Without digits after it, only the "0" is read (as strtod does).
+        template <typename T>
+        std::from_chars_result parse_floating_point(char const* first, char const* last, T& value)
+        {
+            bool const negative = first != last && *first == '-';
+            char const* const prefix = negative ? first + 1 : first;
+            if (last - prefix > 2 && prefix[0] == '0' && (prefix[1] == 'x' || prefix[1] == 'X') && (is_hex_digit(prefix[2]) || prefix[2] == '.')) {
+                T magnitude = T();
+                auto const result = std::from_chars(prefix + 2, last, magnitude, std::chars_format::hex);
+                if (result.ec == std::errc()) {
+                    value = negative ? -magnitude : magnitude;
+                }
+                if (result.ec != std::errc::invalid_argument) { // else, e.g., "0x.p1"
+                    return result;
+                }
+            }
+            return std::from_chars(first, last, value, std::chars_format::general);
+        }
+#else // TUC_HAS_FLOATING_POINT_FROM_CHARS
+        // Falls back to strtod and friends, on a null-terminated copy of the number (which has no
+        // white space in it). These depend on the decimal point of the C locale.
+        template <typename T>
+        std::from_chars_result parse_floating_point(char const* first, char const* last, T& value)
+        {
+            std::string const number(first, std::find_if(first, last, is_space));
+            char* end = nullptr;
+            errno = 0;
+            T parsed = T();
+            if constexpr (std::is_same<T, float>::value) {
+                parsed = std::strtof(number.c_str(), &end);
+            }
+            else if constexpr (std::is_same<T, double>::value) {
+                parsed = std::strtod(number.c_str(), &end);
+            }
+            else {
+                parsed = std::strtold(number.c_str(), &end);
+            }
+            char const* const result = first + (end - number.c_str());
+            if (result == first) {
+                return { first, std::errc::invalid_argument };
+            }
+            if (errno == ERANGE) {
+                return { result, std::errc::result_out_of_range };
+            }
+            value = parsed;
+            return { result, std::errc() };
+        }
+#endif // TUC_HAS_FLOATING_POINT_FROM_CHARS
+
+        // Like from_chars, but also skipping leading white space and a plus sign (as strtod does).
+        // For floating-point types, accepts "nan", "inf" and "infinity" (in any case), and hexadecimal
+        // numbers with a "0x" prefix.
+        template <typename T>
+        std::from_chars_result parse(char const* first, char const* last, T& value)
+        {
+            static_assert(std::is_arithmetic<T>::value && !std::is_same<T, bool>::value, "Arithmetic type required");
+            char const* const begin = skip_spaces(first, last);
+            char const* number = begin;
+            if (number != last && *number == '+' && (number + 1 == last || number[1] != '-')) {
+                ++number;
+            }
+            std::from_chars_result result;
+            if constexpr (std::is_floating_point<T>::value) {
+                result = parse_floating_point(number, last, value);
+            }
+            else {
+                result = std::from_chars(number, last, value, 10);
+            }
+            if (result.ec == std::errc::invalid_argument) {
+                result.ptr = first; // as from_chars does
+            }
+            return result;
+        }
+    }
+}
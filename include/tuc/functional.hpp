@@ -1,21 +1,22 @@
 #pragma once
 
 #include <vector>
+#include <list>
+#include <unordered_map>
+#include <tuple>
+#include <atomic>
+#include <cstdint>
 #include <memory>
+#include <mutex> // std::call_once
+#include <optional>
+#include <future>
 #include <limits>
 #include <functional>
 #include <algorithm>
 #include <iterator>
+#include <assert.h>
 
-#if defined(__GNUC__) && __GNUC__ < 11
-#define TUC_HAS_EXECUTION_POLICY 0
-#elif __cplusplus >= 201703L || (defined (_MSC_VER) && _HAS_CXX17)
-#define TUC_HAS_EXECUTION_POLICY 1
-#include <execution>
-#else // C++17
-#define TUC_HAS_EXECUTION_POLICY 0
-#endif // C++17
-
+#include "execution_policy_detail.hpp"
 #include "functional_detail.hpp"
 
 namespace tuc
@@ -29,21 +30,90 @@ namespace tuc
         return output;
     }
 
+    // An allocator that default-initializes (instead of value-initializes) elements, so that for example
+    // std::vector<float, tuc::default_init_allocator<float>>(n) does not spend time zero-filling the buffer
+    template <typename T, typename Allocator = std::allocator<T>>
+    class default_init_allocator : public Allocator
+    {
+    public:
+        template <typename U>
+        struct rebind {
+            using other = default_init_allocator<U, typename std::allocator_traits<Allocator>::template rebind_alloc<U>>;
+        };
+
+        using Allocator::Allocator;
+
+        template <typename U>
+        void construct(U* pointer) noexcept(std::is_nothrow_default_constructible<U>::value) {
+            ::new(static_cast<void*>(pointer)) U;
+        }
+
+        template <typename U, typename... Arguments>
+        void construct(U* pointer, Arguments&&... arguments) {
+            std::allocator_traits<Allocator>::construct(static_cast<Allocator&>(*this), pointer, std::forward<Arguments>(arguments)...);
+        }
+    };
+
 #if TUC_HAS_EXECUTION_POLICY
+    // If the output elements are not default-constructible, they are first constructed in parallel in
+    // uninitialized storage, and then moved to the output container, which takes two allocations for
+    // a std::vector (with std::execution::seq, they are constructed in the output directly).
     template <typename Output, typename Input, typename MapFunction, typename ExecutionPolicy = std::execution::parallel_unsequenced_policy>
     Output map(ExecutionPolicy execution_policy, Input const& input, MapFunction function)
     {
-        Output output(input.size());
+        using OutputElement = typename Output::value_type;
 
-        std::transform(
-            execution_policy,
-            input.begin(),
-            input.end(),
-            output.begin(),
-            function
-        );
+        if constexpr (std::is_default_constructible<OutputElement>::value) {
+            Output output(input.size());
 
-        return output;
+            if constexpr (detail::is_sequenced_policy<ExecutionPolicy>) {
+                std::transform(input.begin(), input.end(), output.begin(), function);
+            }
+            else {
+                std::transform(
+                    execution_policy,
+                    input.begin(),
+                    input.end(),
+                    output.begin(),
+                    function
+                );
+            }
+
+            return output;
+        }
+        else if constexpr (detail::is_sequenced_policy<ExecutionPolicy>) {
+            Output output;
+            detail::reserve(output, input.size());
+            std::transform(input.begin(), input.end(), std::back_inserter(output), function);
+            return output;
+        }
+        else {
+            detail::uninitialized_buffer<OutputElement> buffer(input.size());
+            buffer.construct(execution_policy, input, function);
+            return Output(
+                std::make_move_iterator(buffer.begin()),
+                std::make_move_iterator(buffer.end())
+            );
+        }
+    }
+
+    // Write into an existing, already sized output (e.g., a buffer reused across calls);
+    // returns an iterator past the last element written.
+    template <typename Input, typename OutputIterator, typename MapFunction, typename ExecutionPolicy = std::execution::parallel_unsequenced_policy>
+    OutputIterator map(ExecutionPolicy execution_policy, Input const& input, OutputIterator output, MapFunction function)
+    {
+        if constexpr (detail::is_sequenced_policy<ExecutionPolicy>) {
+            return std::transform(input.begin(), input.end(), output, function);
+        }
+        else {
+            return std::transform(
+                execution_policy,
+                input.begin(),
+                input.end(),
+                output,
+                function
+            );
+        }
     }
 #endif // TUC_HAS_EXECUTION_POLICY
 
@@ -123,39 +193,226 @@ namespace tuc
     template <typename Input, typename ToValue>
     auto min_element(Input const& input, ToValue to_value)
     {
-        return std::min_element(input.begin(), input.end(), detail::get_compare_function(to_value));
+        auto const is_less = [](auto const& lhs, auto const& rhs) { return lhs < rhs; };
+        return detail::extreme_element(input.begin(), input.end(), to_value, is_less);
     }
 
     template <typename Input, typename ToValue>
     auto max_element(Input const& input, ToValue to_value)
     {
-        return std::max_element(input.begin(), input.end(), detail::get_compare_function(to_value));
+        auto const is_greater = [](auto const& lhs, auto const& rhs) { return rhs < lhs; };
+        return detail::extreme_element(input.begin(), input.end(), to_value, is_greater);
     }
 
     template <typename Input, typename ToValue>
     auto minmax_element(Input const& input, ToValue to_value)
     {
-        return std::minmax_element(input.begin(), input.end(), detail::get_compare_function(to_value));
+        return detail::minmax_element(input.begin(), input.end(), to_value);
     }
 
-    template <typename Result>
+#if TUC_HAS_EXECUTION_POLICY
+    // If `to_value` yields an arithmetic type, the keys are first computed into a buffer, which is then
+    // reduced in parallel (and vectorized, if the execution policy permits). Otherwise, the elements are
+    // compared in parallel, evaluating `to_value` for each comparison.
+    template <typename Input, typename ToValue, typename ExecutionPolicy = std::execution::parallel_unsequenced_policy>
+    auto min_element(ExecutionPolicy execution_policy, Input const& input, ToValue to_value)
+    {
+        if constexpr (std::is_arithmetic<detail::projected_key_t<Input, ToValue>>::value) {
+            auto const keys = detail::get_projected_keys(execution_policy, input, to_value);
+            auto const key = std::min_element(execution_policy, keys.begin(), keys.end());
+            return detail::corresponding_input_iterator(input, keys.begin(), key);
+        }
+        else {
+            return std::min_element(execution_policy, input.begin(), input.end(), detail::get_compare_function(to_value));
+        }
+    }
+
+    template <typename Input, typename ToValue, typename ExecutionPolicy = std::execution::parallel_unsequenced_policy>
+    auto max_element(ExecutionPolicy execution_policy, Input const& input, ToValue to_value)
+    {
+        if constexpr (std::is_arithmetic<detail::projected_key_t<Input, ToValue>>::value) {
+            auto const keys = detail::get_projected_keys(execution_policy, input, to_value);
+            auto const key = std::max_element(execution_policy, keys.begin(), keys.end());
+            return detail::corresponding_input_iterator(input, keys.begin(), key);
+        }
+        else {
+            return std::max_element(execution_policy, input.begin(), input.end(), detail::get_compare_function(to_value));
+        }
+    }
+
+    template <typename Input, typename ToValue, typename ExecutionPolicy = std::execution::parallel_unsequenced_policy>
+    auto minmax_element(ExecutionPolicy execution_policy, Input const& input, ToValue to_value)
+    {
+        if constexpr (std::is_arithmetic<detail::projected_key_t<Input, ToValue>>::value) {
+            auto const keys = detail::get_projected_keys(execution_policy, input, to_value);
+            auto const key = std::minmax_element(execution_policy, keys.begin(), keys.end());
+            return std::make_pair(
+                detail::corresponding_input_iterator(input, keys.begin(), key.first),
+                detail::corresponding_input_iterator(input, keys.begin(), key.second)
+            );
+        }
+        else {
+            return std::minmax_element(execution_policy, input.begin(), input.end(), detail::get_compare_function(to_value));
+        }
+    }
+#endif // TUC_HAS_EXECUTION_POLICY
+
+    // Evaluates `function` at most once, on first use; safe to call get_result() from several threads.
+    // Pass a concrete `Function` type (or let the deduction guide do it) to avoid std::function overhead.
+    // The result is kept inside the object, which is neither copyable nor movable (like its std::once_flag).
+    template <typename Result, typename Function = std::function<Result()>>
     class lazy_evaluator
     {
     public:
-        lazy_evaluator(std::function<Result()> function)
-            : function(function)
+        lazy_evaluator(Function function)
+            : function(std::move(function))
         {}
 
-        Result const& get_result() const {
-            if (!result) {
-                result = std::make_unique<Result>(function());
+        // Start evaluating right away on the given thread pool, so that the result is hopefully
+        // ready by the time it's first needed. The thread pool needs to outlive this object.
+        template <typename ThreadPool>
+        lazy_evaluator(Function function, ThreadPool& thread_pool)
+            : function(std::move(function))
+            , precomputation(thread_pool([this]() { get_result(); }))
+        {}
+
+        ~lazy_evaluator() {
+            if (precomputation.valid()) {
+                precomputation.wait();
             }
+        }
+
+        Result const& get_result() const {
+            std::call_once(once, [this]() { result.emplace(function()); });
             return *result;
         }
 
     private:
-        std::function<Result()> const function;
-        std::unique_ptr<Result> mutable result;
+        lazy_evaluator(lazy_evaluator const&) = delete; // not construction-copyable
+        lazy_evaluator& operator=(lazy_evaluator const&) = delete; // not copyable
+        lazy_evaluator(lazy_evaluator&&) = delete; // not movable, as the precomputation refers to this
+        lazy_evaluator& operator=(lazy_evaluator&&) = delete;
+
+        Function const function;
+        std::once_flag mutable once;
+        std::optional<Result> mutable result;
+        std::future<void> precomputation; // last, so that the rest is ready when it starts
+    };
+
+    template <typename Function>
+    lazy_evaluator(Function) -> lazy_evaluator<decltype(std::declval<Function>()()), Function>;
+
+    template <typename Function, typename ThreadPool>
+    lazy_evaluator(Function, ThreadPool&) -> lazy_evaluator<decltype(std::declval<Function>()()), Function>;
+
+    // Caches the results of an expensive pure function. Thread-safe: the cache is split into shards that
+    // are locked independently, and concurrent misses on the same arguments evaluate the function only once.
+    // When a shard is full, its least recently used result is evicted. The capacity is split among the
+    // shards (of which there are at most as many as the capacity), so that it bounds the total size.
+    template <typename Result, typename... Arguments>
+    class memoize
+    {
+    public:
+        memoize(std::function<Result(Arguments...)> function, size_t capacity = 1024, size_t shard_count = 16)
+            : function(std::move(function))
+        {
+            assert(capacity > 0);
+            assert(shard_count > 0);
+            shard_count = (std::max)((std::min)(shard_count, capacity), size_t(1));
+            for (size_t i = 0; i < shard_count; ++i) {
+                shards.push_back(std::make_unique<shard>());
+                shards.back()->capacity = capacity / shard_count + (i < capacity % shard_count ? 1 : 0);
+            }
+        }
+
+        Result operator()(Arguments const&... arguments)
+        {
+            key_type key(arguments...);
+            auto& s = *shards[detail::tuple_hash()(key) % shards.size()];
+
+            std::promise<Result> promise;
+            std::shared_future<Result> future;
+            bool evaluate = false;
+            uint64_t token = 0;
+
+            {
+                std::lock_guard<std::mutex> lock(s.mutex);
+                auto const i = s.index.find(key);
+                if (i != s.index.end()) {
+                    s.entries.splice(s.entries.begin(), s.entries, i->second); // now the most recently used
+                    future = i->second->result;
+                    ++hits;
+                }
+                else {
+                    future = promise.get_future().share();
+                    token = ++s.last_token;
+                    s.entries.push_front({ key, future, token });
+                    s.index.emplace(key, s.entries.begin());
+                    if (s.entries.size() > s.capacity) {
+                        s.index.erase(s.entries.back().key);
+                        s.entries.pop_back();
+                    }
+                    evaluate = true;
+                    ++misses;
+                }
+            }
+
+            if (evaluate) {
+                try {
+                    promise.set_value(function(arguments...));
+                }
+                catch (...) {
+                    promise.set_exception(std::current_exception());
+                    // Don't cache failures (but if the entry has been evicted meanwhile, leave alone any
+                    // newer one for the same key)
+                    std::lock_guard<std::mutex> lock(s.mutex);
+                    auto const i = s.index.find(key);
+                    if (i != s.index.end() && i->second->token == token) {
+                        s.entries.erase(i->second);
+                        s.index.erase(i);
+                    }
+                }
+            }
+
+            return future.get();
+        }
+
+        size_t get_hit_count() const
+        {
+            return hits;
+        }
+
+        size_t get_miss_count() const
+        {
+            return misses;
+        }
+
+    private:
+        memoize(memoize const&) = delete; // not construction-copyable
+        memoize& operator=(memoize const&) = delete; // not copyable
+
+        using key_type = std::tuple<std::decay_t<Arguments>...>;
+
+        struct entry
+        {
+            key_type key;
+            std::shared_future<Result> result;
+            uint64_t token; // tells apart the entries inserted for the same key at different times
+        };
+
+        struct shard
+        {
+            size_t capacity = 0;
+            std::mutex mutex;
+            uint64_t last_token = 0;
+            std::list<entry> entries; // the most recently used first
+            std::unordered_map<key_type, typename std::list<entry>::iterator, detail::tuple_hash> index;
+        };
+
+        std::function<Result(Arguments...)> const function;
+        std::vector<std::unique_ptr<shard>> shards;
+        std::atomic<size_t> hits{ 0 };
+        std::atomic<size_t> misses{ 0 };
     };
 
     template <typename T>
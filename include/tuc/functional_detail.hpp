@@ -17,5 +17,164 @@ namespace tuc
                 return to_value(lhs) < to_value(rhs);
             };
         }
+
+        // Like std::min_element and std::max_element, but evaluate `to_value` only once per element
+        template <typename Iterator, typename ToValue, typename IsBetter>
+        Iterator extreme_element(Iterator begin, Iterator end, ToValue to_value, IsBetter is_better) {
+            if (begin == end) {
+                return end;
+            }
+            Iterator best = begin;
+            auto best_value = to_value(*begin);
+            for (Iterator i = std::next(begin); i != end; ++i) {
+                auto value = to_value(*i);
+                if (is_better(value, best_value)) {
+                    best = i;
+                    best_value = std::move(value);
+                }
+            }
+            return best;
+        }
+
+        // Like std::minmax_element (first smallest, last largest), but evaluate `to_value` only once per element
+        template <typename Iterator, typename ToValue>
+        std::pair<Iterator, Iterator> minmax_element(Iterator begin, Iterator end, ToValue to_value) {
+            if (begin == end) {
+                return { end, end };
+            }
+            Iterator min = begin, max = begin;
+            auto min_value = to_value(*begin);
+            auto max_value = min_value;
+            for (Iterator i = std::next(begin); i != end; ++i) {
+                auto value = to_value(*i);
+                if (value < min_value) {
+                    min = i;
+                    min_value = value;
+                }
+                if (!(value < max_value)) {
+                    max = i;
+                    max_value = std::move(value);
+                }
+            }
+            return { min, max };
+        }
+
+        struct tuple_hash {
+            template <typename... T>
+            size_t operator()(std::tuple<T...> const& tuple) const {
+                return std::apply([](auto const&... values) {
+                    size_t seed = 0;
+                    // adapted from boost::hash_combine
+                    ((seed ^= std::hash<std::decay_t<decltype(values)>>()(values) + 0x9e3779b9 + (seed << 6) + (seed >> 2)), ...);
+                    return seed;
+                }, tuple);
+            }
+        };
+
+#if TUC_HAS_EXECUTION_POLICY
+        template <typename Input, typename ToValue>
+        using projected_key_t = std::decay_t<decltype(std::declval<ToValue>()(*std::declval<Input const&>().begin()))>;
+
+        // Evaluate `to_value` once per element, in parallel, into a contiguous buffer that can then be reduced using SIMD instructions
+        template <typename ExecutionPolicy, typename Input, typename ToValue>
+        auto get_projected_keys(ExecutionPolicy execution_policy, Input const& input, ToValue to_value) {
+            std::vector<projected_key_t<Input, ToValue>> keys(input.size());
+            std::transform(execution_policy, input.begin(), input.end(), keys.begin(), to_value);
+            return keys;
+        }
+
+        template <typename Input, typename KeyIterator>
+        auto corresponding_input_iterator(Input const& input, KeyIterator keys_begin, KeyIterator key) {
+            return std::next(input.begin(), std::distance(keys_begin, key));
+        }
+
+        // A random-access iterator over the integers, e.g. for running parallel algorithms over indexes
+        class counting_iterator
+        {
+        public:
+            using iterator_category = std::random_access_iterator_tag;
+            using value_type = size_t;
+            using difference_type = std::ptrdiff_t;
+            using pointer = size_t const*;
+            using reference = size_t;
+
+            counting_iterator(size_t value = 0) : value(value) {}
+
+            reference operator*() const { return value; }
+            reference operator[](difference_type n) const { return value + n; }
+
+            counting_iterator& operator++() { ++value; return *this; }
+            counting_iterator& operator--() { --value; return *this; }
+            counting_iterator operator++(int) { auto const old = *this; ++value; return old; }
+            counting_iterator operator--(int) { auto const old = *this; --value; return old; }
+            counting_iterator& operator+=(difference_type n) { value += n; return *this; }
+            counting_iterator& operator-=(difference_type n) { value -= n; return *this; }
+
+            friend counting_iterator operator+(counting_iterator i, difference_type n) { return i += n; }
+            friend counting_iterator operator+(difference_type n, counting_iterator i) { return i += n; }
+            friend counting_iterator operator-(counting_iterator i, difference_type n) { return i -= n; }
+            friend difference_type operator-(counting_iterator lhs, counting_iterator rhs) {
+                return static_cast<difference_type>(lhs.value) - static_cast<difference_type>(rhs.value);
+            }
+
+            friend bool operator==(counting_iterator lhs, counting_iterator rhs) { return lhs.value == rhs.value; }
+            friend bool operator!=(counting_iterator lhs, counting_iterator rhs) { return lhs.value != rhs.value; }
+            friend bool operator<(counting_iterator lhs, counting_iterator rhs) { return lhs.value < rhs.value; }
+            friend bool operator>(counting_iterator lhs, counting_iterator rhs) { return lhs.value > rhs.value; }
+            friend bool operator<=(counting_iterator lhs, counting_iterator rhs) { return lhs.value <= rhs.value; }
+            friend bool operator>=(counting_iterator lhs, counting_iterator rhs) { return lhs.value >= rhs.value; }
+
+        private:
+            size_t value;
+        };
+
+        // The standard algorithms call std::terminate if an element function throws, even with
+        // std::execution::seq; for that policy, plain loops are used instead, so that exceptions propagate
+        template <typename ExecutionPolicy>
+        inline constexpr bool is_sequenced_policy = std::is_same<std::decay_t<ExecutionPolicy>, std::execution::sequenced_policy>::value;
+
+        // Storage for `size` elements that are constructed in place, without requiring a default constructor
+        template <typename T>
+        class uninitialized_buffer
+        {
+        public:
+            uninitialized_buffer(size_t size)
+                : data(std::allocator<T>().allocate(size))
+                , size(size)
+            {}
+
+            ~uninitialized_buffer() {
+                std::destroy(data, data + constructed_count);
+                std::allocator<T>().deallocate(data, size);
+            }
+
+            template <typename ExecutionPolicy, typename Input, typename MapFunction>
+            void construct(ExecutionPolicy execution_policy, Input const& input, MapFunction function) {
+                static_assert(
+                    std::is_base_of<std::random_access_iterator_tag, typename std::iterator_traits<decltype(input.begin())>::iterator_category>::value,
+                    "Random-access input required"
+                );
+                assert(constructed_count == 0);
+                assert(input.size() == size);
+                auto const input_begin = input.begin();
+                // An exception from function calls std::terminate, so all the elements get constructed
+                std::for_each(execution_policy, counting_iterator(0), counting_iterator(size), [&](size_t i) {
+                    ::new(static_cast<void*>(data + i)) T(function(input_begin[i]));
+                });
+                constructed_count = size;
+            }
+
+            T* begin() { return data; }
+            T* end() { return data + size; }
+
+        private:
+            uninitialized_buffer(uninitialized_buffer const&) = delete; // not construction-copyable
+            uninitialized_buffer& operator=(uninitialized_buffer const&) = delete; // not copyable
+
+            T* const data;
+            size_t const size;
+            size_t constructed_count = 0; // from the beginning
+        };
+#endif // TUC_HAS_EXECUTION_POLICY
     }
 }
\ No newline at end of file
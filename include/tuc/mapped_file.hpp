@@ -0,0 +1,298 @@
+#pragma once
+
+#include "filesystem.hpp"
+#include <algorithm>
+#include <cerrno>
+#include <cstddef>
+#include <iterator>
+#include <string_view>
+#include <system_error>
+#include <utility>
+#include <vector>
+
+#ifdef WIN32
+#ifndef WIN32_LEAN_AND_MEAN
+#define WIN32_LEAN_AND_MEAN
+#endif // WIN32_LEAN_AND_MEAN
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif // NOMINMAX
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif // WIN32
+
+namespace tuc
+{
+    // A lazy range of the lines of a text, as views into it without the line breaks ("\n" or "\r\n").
+    // A final line break does not start another (empty) line.
+    class line_range
+    {
+    public:
+        line_range(std::string_view text)
+            : text(text)
+        {}
+
+        class iterator
+        {
+        public:
+            using iterator_category = std::forward_iterator_tag;
+            using value_type = std::string_view;
+            using difference_type = std::ptrdiff_t;
+            using pointer = value_type const*;
+            using reference = value_type const&;
+
+            iterator() = default;
+
+            reference operator*() const { return line; }
+            pointer operator->() const { return &line; }
+
+            iterator& operator++() {
+                if (next == text.length()) {
+                    next = std::string_view::npos; // the end
+                }
+                else {
+                    find_line();
+                }
+                return *this;
+            }
+
+            iterator operator++(int) {
+                iterator result = *this;
+                ++*this;
+                return result;
+            }
+
+            bool operator==(iterator const& that) const {
+                return next == that.next;
+            }
+
+            bool operator!=(iterator const& that) const { return !(*this == that); }
+
+        private:
+            friend class line_range;
+
+            explicit iterator(std::string_view text)
+                : text(text)
+                , next(0)
+            {
+                ++*this;
+            }
+
+            void find_line() {
+                size_t const line_break = text.find('\n', next); // memchr
+                size_t const end = line_break == std::string_view::npos ? text.length() : line_break;
+                line = text.substr(next, end - next);
+                if (!line.empty() && line.back() == '\r') {
+                    line.remove_suffix(1);
+                }
+                next = line_break == std::string_view::npos ? text.length() : line_break + 1;
+            }
+
+            std::string_view text;
+            std::string_view line;
+            size_t next = std::string_view::npos; // npos at the end
+        };
+
+        iterator begin() const { return iterator(text); }
+        iterator end() const { return iterator(); }
+
+    private:
+        std::string_view const text;
+    };
+
+    // Splits the text into (at most) chunk_count contiguous chunks of about the same size, each ending
+    // with a line break (except maybe the last one), so that they can be parsed independently, e.g.
+    // with thread_pool::launch_in_chunks
+    inline std::vector<std::string_view> split_into_line_chunks(std::string_view text, size_t chunk_count)
+    {
+        std::vector<std::string_view> chunks;
+        size_t const target_size = (std::max)(text.length() / (std::max)(chunk_count, size_t(1)), size_t(1));
+        size_t begin = 0;
+        while (begin < text.length()) {
+            size_t end = text.length();
+            if (chunks.size() + 1 < chunk_count && text.length() - begin > target_size) {
+                size_t const line_break = text.find('\n', begin + target_size - 1);
+                if (line_break != std::string_view::npos) {
+                    end = line_break + 1;
+                }
+            }
+            chunks.push_back(text.substr(begin, end - begin));
+            begin = end;
+        }
+        return chunks;
+    }
+
+    enum struct access_hint
+    {
+        normal,
+        sequential, // more read-ahead, and pages may be dropped soon after being read
+        random, // no read-ahead
+        will_need // start reading in now
+    };
+
+    // A read-only memory mapping of a whole file, unmapped on destruction. Opening throws
+    // fs::filesystem_error. The file should not be modified while it is mapped.
+    class mapped_file
+    {
+    public:
+        mapped_file() = default;
+
+        explicit mapped_file(fs::path const& path, access_hint hint = access_hint::normal)
+        {
+            open(path, hint);
+        }
+
+        mapped_file(mapped_file&& that) noexcept
+            : view(std::exchange(that.view, std::string_view()))
+        {}
+
+        mapped_file& operator=(mapped_file&& that) noexcept {
+            if (this != &that) {
+                close();
+                view = std::exchange(that.view, std::string_view());
+            }
+            return *this;
+        }
+
+        mapped_file(mapped_file const&) = delete;
+        mapped_file& operator=(mapped_file const&) = delete;
+
+        ~mapped_file() {
+            close();
+        }
+
+        void open(fs::path const& path, access_hint hint = access_hint::normal);
+
+        void close() noexcept;
+
+        // Only a hint, so errors are ignored. Windows has no equivalent of madvise, so there the hint
+        // given when opening is what counts.
+        void advise([[maybe_unused]] access_hint hint) const noexcept
+        {
+#ifndef WIN32
+            if (view.empty()) {
+                return;
+            }
+            int advice = MADV_NORMAL;
+            switch (hint) {
+            case access_hint::normal: advice = MADV_NORMAL; break;
+            case access_hint::sequential: advice = MADV_SEQUENTIAL; break;
+            case access_hint::random: advice = MADV_RANDOM; break;
+            case access_hint::will_need: advice = MADV_WILLNEED; break;
+            }
+            madvise(const_cast<char*>(view.data()), view.size(), advice);
+#endif // WIN32
+        }
+
+        char const* data() const noexcept { return view.data(); }
+        size_t size() const noexcept { return view.size(); }
+        bool empty() const noexcept { return view.empty(); }
+        char const* begin() const noexcept { return view.data(); }
+        char const* end() const noexcept { return view.data() + view.size(); }
+
+        std::string_view get_view() const noexcept {
+            return view;
+        }
+
+        line_range get_lines() const {
+            return line_range(get_view());
+        }
+
+        std::vector<std::string_view> get_chunks(size_t chunk_count) const {
+            return split_into_line_chunks(get_view(), chunk_count);
+        }
+
+    private:
+        std::string_view view; // of the whole mapping
+    };
+
+#ifdef WIN32
+    inline void mapped_file::open(fs::path const& path, access_hint hint)
+    {
+        close();
+        auto const throw_last_error = [&path]() {
+            throw fs::filesystem_error("tuc::mapped_file", path, std::error_code(static_cast<int>(GetLastError()), std::system_category()));
+        };
+        DWORD const flags = hint == access_hint::sequential ? FILE_FLAG_SEQUENTIAL_SCAN
+            : hint == access_hint::random ? FILE_FLAG_RANDOM_ACCESS
+            : FILE_ATTRIBUTE_NORMAL;
+        HANDLE const file = CreateFileW(path.wstring().c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, flags, nullptr);
+        if (file == INVALID_HANDLE_VALUE) {
+            throw_last_error();
+        }
+        LARGE_INTEGER file_size = {};
+        if (!GetFileSizeEx(file, &file_size)) {
+            CloseHandle(file);
+            throw_last_error();
+        }
+        if (file_size.QuadPart == 0) { // cannot be mapped
+            CloseHandle(file);
+            return;
+        }
+        HANDLE const mapping = CreateFileMappingW(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+        CloseHandle(file); // the mapping keeps it open
+        if (mapping == nullptr) {
+            throw_last_error();
+        }
+        void const* const data = MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+        CloseHandle(mapping); // and so does the view
+        if (data == nullptr) {
+            throw_last_error();
+        }
+        view = std::string_view(static_cast<char const*>(data), static_cast<size_t>(file_size.QuadPart));
+    }
+
+    inline void mapped_file::close() noexcept
+    {
+        if (!view.empty()) {
+            UnmapViewOfFile(view.data());
+        }
+        view = std::string_view();
+    }
+#else
+    inline void mapped_file::open(fs::path const& path, access_hint hint)
+    {
+        close();
+        auto const throw_errno = [&path]() {
+            throw fs::filesystem_error("tuc::mapped_file", path, std::error_code(errno, std::generic_category()));
+        };
+        int const file = ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+        if (file < 0) {
+            throw_errno();
+        }
+        struct stat status = {};
+        if (fstat(file, &status) != 0) {
+            int const error = errno;
+            ::close(file);
+            errno = error;
+            throw_errno();
+        }
+        size_t const file_size = static_cast<size_t>(status.st_size);
+        if (file_size == 0) { // cannot be mapped
+            ::close(file);
+            return;
+        }
+        void* const data = mmap(nullptr, file_size, PROT_READ, MAP_PRIVATE, file, 0);
+        int const error = errno;
+        ::close(file); // the mapping keeps it open
+        if (data == MAP_FAILED) {
+            errno = error;
+            throw_errno();
+        }
+        view = std::string_view(static_cast<char const*>(data), file_size);
+        advise(hint);
+    }
+
+    inline void mapped_file::close() noexcept
+    {
+        if (!view.empty()) {
+            munmap(const_cast<char*>(view.data()), view.size());
+        }
+        view = std::string_view();
+    }
+#endif // WIN32
+}
@@ -7,6 +7,8 @@
 #include <assert.h>
 #include <string>
 #include <stdexcept>
+#include <vector>
+#include "numeric_detail.hpp"
 
 namespace tuc
 { 
@@ -37,32 +39,169 @@ namespace tuc
             : numerator / denominator;
     }
 
-    // A convenience wrapper for combined rounding and typecasting
-    template <typename Output = int, typename Input>
-    Output round(Input input)
+    // For dividing many numbers by the same denominator: the division is replaced by a multiplication
+    // and shifts, precomputed once. Gives the same results as the functions above.
+    template <typename T>
+    class divider
     {
-        static_assert(std::is_integral<Output>::value, "Integral output type required - use std::round for other purposes");
-        auto const rounded = std::round(input);
-        if (rounded < std::numeric_limits<Output>::lowest() || rounded > (std::numeric_limits<Output>::max)()) {
+    public:
+        explicit divider(T denominator)
+            : denominator(denominator)
+            , half_denominator(denominator / 2)
+            , reciprocal(absolute_value(denominator))
+        {
+            static_assert(std::is_integral<T>::value, "Integral type required");
+            assert(denominator != 0);
+        }
+
+        // Rounds towards zero, like the built-in division
+        T divide(T numerator) const {
+            return static_cast<T>(divide_promoted(numerator));
+        }
+
+        T divide_rounding_up(T numerator) const {
+            return static_cast<T>(numerator == 0
+                ? 0
+                : 1 + divide_promoted(numerator - 1));
+        }
+
+        T divide_rounding_to_closest(T numerator) const {
+            return static_cast<T>(is_negative(numerator) ^ is_negative(denominator)
+                ? divide_promoted(numerator - half_denominator)
+                : divide_promoted(numerator + half_denominator));
+        }
+
+        T divide_rounding_down(T numerator) const {
+            return static_cast<T>(is_negative(numerator) ^ is_negative(denominator)
+                ? divide_promoted(numerator - denominator + 1)
+                : divide_promoted(numerator));
+        }
+
+        // Batch versions: divide each element in [begin, end), writing to `output` (which may be the same as the input)
+
+        void divide(T const* begin, T const* end, T* output) const {
+            std::transform(begin, end, output, [this](T numerator) { return divide(numerator); });
+        }
+
+        void divide_rounding_up(T const* begin, T const* end, T* output) const {
+            std::transform(begin, end, output, [this](T numerator) { return divide_rounding_up(numerator); });
+        }
+
+        void divide_rounding_to_closest(T const* begin, T const* end, T* output) const {
+            std::transform(begin, end, output, [this](T numerator) { return divide_rounding_to_closest(numerator); });
+        }
+
+        void divide_rounding_down(T const* begin, T const* end, T* output) const {
+            std::transform(begin, end, output, [this](T numerator) { return divide_rounding_down(numerator); });
+        }
+
+        T get_denominator() const {
+            return denominator;
+        }
+
+    private:
+        // Like the built-in operators, do the arithmetic in (at least) int
+        using promoted = decltype(T() + T());
+        using unsigned_promoted = std::make_unsigned_t<promoted>;
+
+        static bool is_negative(promoted value) {
+            if constexpr (std::is_signed<promoted>::value) {
+                return value < 0;
+            }
+            else {
+                return false;
+            }
+        }
+
+        static unsigned_promoted absolute_value(promoted value) {
+            return is_negative(value)
+                ? static_cast<unsigned_promoted>(0 - static_cast<unsigned_promoted>(value))
+                : static_cast<unsigned_promoted>(value);
+        }
+
+        promoted divide_promoted(promoted numerator) const {
+            unsigned_promoted const quotient = reciprocal.divide(absolute_value(numerator));
+            return static_cast<promoted>(is_negative(numerator) ^ is_negative(denominator)
+                ? 0 - quotient
+                : quotient);
+        }
+
+        promoted const denominator;
+        promoted const half_denominator;
+        numeric_detail::unsigned_divider<unsigned_promoted> const reciprocal;
+    };
+
+    namespace round_detail {
+        template <typename Output, typename Input>
+        [[noreturn]] void throw_overflow(Input input) {
             throw std::runtime_error(
                 "Numeric overflow in tuc::round (input = " + std::to_string(input) + "," +
                 " valid range = [" + std::to_string(std::numeric_limits<Output>::lowest()) +
                 ", " + std::to_string((std::numeric_limits<Output>::max)()) + "])"
             );
         }
+    }
+
+    // A convenience wrapper for combined rounding and typecasting
+    template <typename Output = int, typename Input>
+    Output round(Input input)
+    {
+        static_assert(std::is_integral<Output>::value, "Integral output type required - use std::round for other purposes");
+        auto const rounded = std::round(input);
+        if (!numeric_detail::is_representable<Output>(rounded)) {
+            round_detail::throw_overflow<Output>(input);
+        }
         return static_cast<Output>(rounded);
     }
 
+    // What the batch version of round should do with values that do not fit in the output type
+    enum struct overflow_policy {
+        saturate,       // clamp to the valid range (NaN becomes zero)
+        stop,           // stop at the first such value (see the return value)
+        throw_exception // like the scalar version
+    };
+
+    // Rounds and typecasts a batch of values; the output may alias the input if the types are of the
+    // same size. Returns the number of values converted, which is less than the batch size only if
+    // the policy is to stop: then it is the index of the first value that does not fit.
+    // float -> int32_t, int16_t, uint16_t and uint8_t conversions are vectorized.
+    template <typename Output, typename Input>
+    size_t round(Input const* begin, Input const* end, Output* output, overflow_policy policy = overflow_policy::throw_exception)
+    {
+        static_assert(std::is_integral<Output>::value, "Integral output type required - use std::round for other purposes");
+        size_t const count = end - begin;
+        size_t i = 0;
+        if constexpr (std::is_same<Input, float>::value && numeric_detail::has_simd_round_v<Output>) {
+            i = numeric_detail::simd_round(begin, output, count, policy == overflow_policy::saturate);
+        }
+        for (; i < count; ++i) {
+            auto const rounded = std::round(begin[i]);
+            if (numeric_detail::is_representable<Output>(rounded)) {
+                output[i] = static_cast<Output>(rounded);
+            }
+            else if (policy == overflow_policy::saturate) {
+                output[i] = numeric_detail::saturate<Output>(rounded);
+            }
+            else if (policy == overflow_policy::stop) {
+                return i;
+            }
+            else {
+                round_detail::throw_overflow<Output>(begin[i]);
+            }
+        }
+        return count;
+    }
+
     template <typename T>
     T lerp(T const& v0, T const& v1, double t) {
-        return (1.0 - t) * v0 + t * v1;
+        return numeric_detail::lerp(v0, v1, t);
     }
 
     // Provide a simple clamp function that can be used with pre-C++17 compilers
     template <typename T>
     T clamp(T const& value, T const& low_limit, T const& high_limit) {
         assert(low_limit <= high_limit);
-        return (std::max)(low_limit, (std::min)(high_limit, value));
+        return numeric_detail::clamp(value, low_limit, high_limit);
     }
 
     template <typename T>
@@ -117,23 +256,64 @@ namespace tuc
         template <typename T>
         T prepare(T const& left_edge, T const& right_edge, T const& v) {
             assert(right_edge > left_edge);
-            return tuc::clamp<T>(
-                (v - left_edge) / (right_edge - left_edge),
-                0, 1
-            );
+            return numeric_detail::smoothstep_prepare(left_edge, right_edge - left_edge, v);
         }
     }
 
     template <typename T>
     T smoothstep(T const& left_edge, T const& right_edge, T const& v) {
         T const x = smoothstep_detail::prepare(left_edge, right_edge, v);
-        return x * x * (3 - 2 * x);
+        return numeric_detail::smoothstep_polynomial(x);
     }
 
     template <typename T>
     T smootherstep(T const& left_edge, T const& right_edge, T const& v) {
         T const x = smoothstep_detail::prepare(left_edge, right_edge, v);
-        return x * x * x * (x * (x * 6 - 15) + 10);
+        return numeric_detail::smootherstep_polynomial(x);
+    }
+
+    // Batch versions of the above: process a whole buffer at a time, writing to `output` (which may be
+    // the same as the input). For float, explicit SIMD kernels are used if supported by the CPU; the
+    // results are bit-for-bit identical to those of the scalar functions.
+
+    template <typename T>
+    void lerp(T const* v0_begin, T const* v0_end, T const* v1_begin, T* output, double t) {
+        numeric_detail::lerp(v0_begin, v0_end, v1_begin, output, t);
+    }
+
+    template <typename T>
+    void clamp(T const* begin, T const* end, T* output, T const& low_limit, T const& high_limit) {
+        assert(low_limit <= high_limit);
+        numeric_detail::clamp(begin, end, output, low_limit, high_limit);
+    }
+
+    template <typename T>
+    void smoothstep(T const& left_edge, T const& right_edge, T const* begin, T const* end, T* output) {
+        assert(right_edge > left_edge);
+        numeric_detail::smoothstep(left_edge, right_edge, begin, end, output);
+    }
+
+    template <typename T>
+    void smootherstep(T const& left_edge, T const& right_edge, T const* begin, T const* end, T* output) {
+        assert(right_edge > left_edge);
+        numeric_detail::smootherstep(left_edge, right_edge, begin, end, output);
+    }
+
+    namespace power_mean_detail {
+        // allow -inf and +inf as input
+        template <typename P>
+        P limit(P p) {
+            constexpr P min_value = -(std::numeric_limits<P>::max)();
+            constexpr P max_value = +(std::numeric_limits<P>::max)();
+            static_assert(min_value < max_value, "`min_value` should be lower than `max_value`");
+            if (p < min_value) {
+                return min_value;
+            }
+            else if (p > max_value) {
+                return max_value;
+            }
+            return p;
+        }
     }
 
     template <typename T>
@@ -143,14 +323,18 @@ namespace tuc
         return (zero < value) - (value < zero);
     }
 
+    // The means are computed robustly: sums are compensated (so that the error doesn't grow with the
+    // number of values), and products keep track of the exponent separately (so that they can't
+    // overflow or underflow). Contiguous ranges of float or double are summed using SIMD instructions.
+
     template <typename Iterator, typename T = double>
     T arithmetic_mean(Iterator begin, Iterator end) {
-        return std::accumulate(begin, end, static_cast<T>(0)) / std::distance(begin, end);
+        return numeric_detail::sum<T>(begin, end).get() / std::distance(begin, end);
     }
 
     template <typename Iterator, typename T = double>
     T geometric_mean(Iterator begin, Iterator end) {
-        return std::pow(std::accumulate(begin, end, static_cast<T>(1), std::multiplies<T>()), 1.0 / std::distance(begin, end));
+        return numeric_detail::product<T>(begin, end).root(std::distance(begin, end));
     }
 
     template <typename Iterator, typename T = double, typename P = double>
@@ -158,25 +342,444 @@ namespace tuc
         if (p == 0) {
             return tuc::geometric_mean(begin, end);
         }
-        { // allow -inf and +inf as input
-            constexpr P min_value = -(std::numeric_limits<P>::max)();
-            constexpr P max_value = +(std::numeric_limits<P>::max)();
-            static_assert(min_value < max_value, "`min_value` should be lower than `max_value`");
-            if (p < min_value) {
-                p = min_value;
+        if (p == 1) {
+            return tuc::arithmetic_mean<Iterator, T>(begin, end);
+        }
+        p = power_mean_detail::limit(p);
+        auto const sum = numeric_detail::sum<T>(begin, end, numeric_detail::power<T, P>(p));
+        auto const result = std::pow(sum.get() / std::distance(begin, end), 1.0 / p);
+        if (std::isinf(result)) {
+            return *std::max_element(begin, end);
+        }
+        return result;
+    }
+
+    // Single-pass statistics that can be updated one value at a time, without keeping the values in
+    // memory. Accumulators updated in different threads (or windows) can be merged using +=.
+    template <typename T = double>
+    class running_statistics
+    {
+    public:
+        void add(T const& value) {
+            // Welford's algorithm
+            ++count;
+            T const delta = value - mean;
+            mean += delta / static_cast<T>(count);
+            sum_of_squared_deviations += delta * (value - mean);
+            min = (std::min)(min, value);
+            max = (std::max)(max, value);
+        }
+
+        running_statistics& operator+=(running_statistics const& that) {
+            // Chan et al.: https://en.wikipedia.org/wiki/Algorithms_for_calculating_variance#Parallel_algorithm
+            if (that.count == 0) {
+                return *this;
             }
-            else if (p > max_value) {
-                p = max_value;
+            if (count == 0) {
+                return *this = that;
+            }
+            size_t const total_count = count + that.count;
+            T const delta = that.mean - mean;
+            T const that_weight = static_cast<T>(that.count) / static_cast<T>(total_count);
+            mean += delta * that_weight;
+            sum_of_squared_deviations += that.sum_of_squared_deviations + delta * delta * static_cast<T>(count) * that_weight;
+            count = total_count;
+            min = (std::min)(min, that.min);
+            max = (std::max)(max, that.max);
+            return *this;
+        }
+
+        size_t get_count() const { return count; }
+        T get_mean() const { return count > 0 ? mean : std::numeric_limits<T>::quiet_NaN(); }
+        T get_min() const { return min; }
+        T get_max() const { return max; }
+
+        // The population variance (divided by n)
+        T get_variance() const {
+            return sum_of_squared_deviations / static_cast<T>(count);
+        }
+
+        // The unbiased sample variance (divided by n - 1)
+        T get_sample_variance() const {
+            return sum_of_squared_deviations / static_cast<T>(count - 1);
+        }
+
+        T get_standard_deviation() const {
+            return std::sqrt(get_variance());
+        }
+
+    private:
+        size_t count = 0;
+        T mean = 0;
+        T sum_of_squared_deviations = 0;
+        T min = (std::numeric_limits<T>::max)();
+        T max = std::numeric_limits<T>::lowest();
+    };
+
+    // A single-pass counterpart of power_mean: gives the same result, but one value at a time
+    template <typename T = double, typename P = double>
+    class running_power_mean
+    {
+    public:
+        running_power_mean(P p)
+            : p(p == 0 || p == 1 ? p : power_mean_detail::limit(p))
+            , power(this->p)
+        {}
+
+        void add(T const& value) {
+            ++count;
+            if (p == 0) {
+                product *= value;
+            }
+            else {
+                sum += power(value);
+            }
+            max = (std::max)(max, value);
+        }
+
+        running_power_mean& operator+=(running_power_mean const& that) {
+            assert(p == that.p);
+            count += that.count;
+            product *= that.product;
+            sum += that.sum;
+            max = (std::max)(max, that.max);
+            return *this;
+        }
+
+        size_t get_count() const { return count; }
+
+        T get() const {
+            if (p == 0) {
+                return product.root(count);
+            }
+            auto const result = std::pow(sum.get() / static_cast<T>(count), 1.0 / p);
+            if (p != 1 && std::isinf(result)) {
+                return max;
+            }
+            return result;
+        }
+
+    private:
+        P const p;
+        numeric_detail::power<T, P> const power;
+        size_t count = 0;
+        numeric_detail::compensated_sum<T> sum;
+        numeric_detail::scaled_product<T> product;
+        T max = std::numeric_limits<T>::lowest();
+    };
+
+    // A fixed-size histogram of non-negative integers (e.g., latencies in microseconds), in the spirit
+    // of HdrHistogram: the buckets get wider logarithmically, so that the relative error of a quantile
+    // is bounded by the requested number of significant decimal digits. Adding a value is O(1). To
+    // record from several threads, use one histogram per thread, and merge them afterwards.
+    class log_histogram
+    {
+    public:
+        log_histogram(uint64_t highest_trackable_value, int significant_digits = 3)
+            : sub_bucket_bits(get_sub_bucket_bits(significant_digits))
+            , highest_trackable_value(highest_trackable_value)
+            , counts(get_index(highest_trackable_value) + 1)
+        {}
+
+        // Values above the highest trackable value are counted in the highest bucket
+        // (but get_max() still returns the actual maximum)
+        void add(uint64_t value, uint64_t count = 1) {
+            if (count == 0) {
+                return;
+            }
+            counts[get_index((std::min)(value, highest_trackable_value))] += count;
+            total_count += count;
+            min = (std::min)(min, value);
+            max = (std::max)(max, value);
+        }
+
+        log_histogram& operator+=(log_histogram const& that) {
+            assert(sub_bucket_bits == that.sub_bucket_bits);
+            if (that.counts.size() > counts.size()) {
+                counts.resize(that.counts.size());
+                highest_trackable_value = that.highest_trackable_value;
             }
+            for (size_t i = 0, end = that.counts.size(); i < end; ++i) {
+                counts[i] += that.counts[i];
+            }
+            total_count += that.total_count;
+            min = (std::min)(min, that.min);
+            max = (std::max)(max, that.max);
+            return *this;
         }
-        auto const accumulate = [p](T a, T b) {
-            return a + pow(b, p);
+
+        uint64_t get_count() const { return total_count; }
+        uint64_t get_min() const { return min; }
+        uint64_t get_max() const { return max; }
+
+        // For example, get_quantile(0.99) returns the 99th percentile (or 0, if nothing has been added)
+        uint64_t get_quantile(double q) const {
+            if (total_count == 0) {
+                return 0;
+            }
+            if (q <= 0) {
+                return min;
+            }
+            if (q >= 1) {
+                return max;
+            }
+            uint64_t const rank = (std::max)(static_cast<uint64_t>(std::ceil(q * static_cast<double>(total_count))), uint64_t(1));
+            uint64_t count_so_far = 0;
+            for (size_t i = 0, end = counts.size(); i < end; ++i) {
+                count_so_far += counts[i];
+                if (count_so_far >= rank) {
+                    // The middle of the bucket, but within the range of the actual values
+                    uint64_t const middle = get_lowest_value(i) + (get_bucket_width(i) - 1) / 2;
+                    return (std::max)(min, (std::min)(max, middle));
+                }
+            }
+            return max;
+        }
+
+    private:
+        static int get_sub_bucket_bits(int significant_digits) {
+            assert(significant_digits >= 0 && significant_digits <= 5);
+            // Values up to 2 * 10^significant_digits are counted exactly
+            uint64_t exact_up_to = 2;
+            for (int i = 0; i < significant_digits; ++i) {
+                exact_up_to *= 10;
+            }
+            return numeric_detail::floor_log2(exact_up_to - 1) + 1;
+        }
+
+        uint64_t get_sub_bucket_count() const { return uint64_t(1) << sub_bucket_bits; }
+
+        // Up to sub_bucket_count, each bucket is 1 wide; after that, the width doubles every
+        // sub_bucket_count / 2 buckets
+        size_t get_index(uint64_t value) const {
+            if (value < get_sub_bucket_count()) {
+                return static_cast<size_t>(value);
+            }
+            int const shift = numeric_detail::floor_log2(value) - (sub_bucket_bits - 1);
+            return static_cast<size_t>(shift * (get_sub_bucket_count() / 2) + (value >> shift));
+        }
+
+        int get_shift(size_t index) const {
+            return index < get_sub_bucket_count()
+                ? 0
+                : static_cast<int>(index / (get_sub_bucket_count() / 2)) - 1;
+        }
+
+        uint64_t get_lowest_value(size_t index) const {
+            int const shift = get_shift(index);
+            return (index - shift * (get_sub_bucket_count() / 2)) << shift;
+        }
+
+        uint64_t get_bucket_width(size_t index) const {
+            return uint64_t(1) << get_shift(index);
+        }
+
+        int const sub_bucket_bits;
+        uint64_t highest_trackable_value;
+        std::vector<uint64_t> counts;
+        uint64_t total_count = 0;
+        uint64_t min = (std::numeric_limits<uint64_t>::max)();
+        uint64_t max = 0;
+    };
+
+    // A t-digest (Dunning & Ertl): a compact summary of a distribution, accurate especially near the
+    // tails. Adding a value is amortized O(1): the values are buffered, and the buffer is merged into
+    // the centroids when it fills up. The size is bounded by the compression parameter. Digests can
+    // be merged, so e.g. thread-local ones can be combined. The const functions do not modify the
+    // digest, so they may be called from several threads at once.
+    template <typename T = double>
+    class quantile_digest
+    {
+    public:
+        quantile_digest(T compression = 100)
+            : compression(compression)
+            , buffer_capacity(static_cast<size_t>(5 * compression))
+        {
+            assert(compression >= 1);
+            buffer.reserve(buffer_capacity);
+        }
+
+        // NaNs are ignored
+        void add(T const& value) {
+            if (std::isnan(value)) {
+                return;
+            }
+            buffer.push_back(centroid{ value, 1 });
+            total_weight += 1;
+            min = (std::min)(min, value);
+            max = (std::max)(max, value);
+            if (buffer.size() >= buffer_capacity) {
+                merge(centroids, buffer, compression);
+            }
+        }
+
+        quantile_digest& operator+=(quantile_digest const& that) {
+            if (&that == this) {
+                return *this += quantile_digest(that);
+            }
+            buffer.insert(buffer.end(), that.centroids.begin(), that.centroids.end());
+            buffer.insert(buffer.end(), that.buffer.begin(), that.buffer.end());
+            merge(centroids, buffer, compression);
+            total_weight += that.total_weight;
+            min = (std::min)(min, that.min);
+            max = (std::max)(max, that.max);
+            return *this;
+        }
+
+        size_t get_count() const { return static_cast<size_t>(total_weight); }
+        T get_min() const { return min; }
+        T get_max() const { return max; }
+
+        // The memory used, in centroids; each buffered value counts as one
+        size_t get_centroid_count() const { return centroids.size() + buffer.size(); }
+
+        // For example, get_quantile(0.99) returns the 99th percentile (or NaN, if nothing has been added).
+        // Values still in the buffer are merged into a copy of the centroids.
+        T get_quantile(double q) const {
+            if (total_weight == 0) {
+                return std::numeric_limits<T>::quiet_NaN();
+            }
+            if (q <= 0) {
+                return min;
+            }
+            if (q >= 1) {
+                return max;
+            }
+            std::vector<centroid> merged_centroids;
+            if (!buffer.empty()) {
+                merged_centroids = centroids;
+                std::vector<centroid> pending = buffer;
+                merge(merged_centroids, pending, compression);
+            }
+            std::vector<centroid> const& sorted_centroids = buffer.empty() ? centroids : merged_centroids;
+
+            // The weight of each centroid is considered to be centered at its mean; interpolate
+            // linearly between the centers (and the extremes)
+            T const target = static_cast<T>(q) * total_weight;
+            T weight_so_far = 0;
+            T previous_center = 0;
+            T previous_mean = min;
+            for (auto const& c : sorted_centroids) {
+                T const center = weight_so_far + c.weight / 2;
+                if (target < center) {
+                    return previous_mean + (c.mean - previous_mean) * (target - previous_center) / (center - previous_center);
+                }
+                weight_so_far += c.weight;
+                previous_center = center;
+                previous_mean = c.mean;
+            }
+            return previous_mean + (max - previous_mean) * (target - previous_center) / (total_weight - previous_center);
+        }
+
+    private:
+        struct centroid
+        {
+            T mean;
+            T weight;
         };
-        auto const result = std::pow(std::accumulate(begin, end, static_cast<T>(0), accumulate) / std::distance(begin, end), 1.0 / p);
+
+        // The largest cumulative weight that the centroid starting at weight_so_far may reach,
+        // according to the k1 scale function k(q) = compression / (2 pi) * asin(2q - 1)
+        static T get_weight_limit(T weight_so_far, T total_weight, T compression) {
+            T const pi = static_cast<T>(3.14159265358979323846);
+            T const k = compression / (2 * pi) * std::asin(2 * weight_so_far / total_weight - 1) + 1;
+            if (k >= compression / 4) {
+                return total_weight;
+            }
+            return total_weight * (std::sin(k * 2 * pi / compression) + 1) / 2;
+        }
+
+        // Merges the buffer into the centroids, leaving it empty. The limits come from the weight
+        // being merged, so that they are valid whatever the state of the rest of the digest.
+        static void merge(std::vector<centroid>& centroids, std::vector<centroid>& buffer, T compression) {
+            if (buffer.empty()) {
+                return;
+            }
+            buffer.insert(buffer.end(), centroids.begin(), centroids.end());
+            std::sort(buffer.begin(), buffer.end(), [](centroid const& lhs, centroid const& rhs) { return lhs.mean < rhs.mean; });
+            centroids.clear();
+
+            T total_weight = 0;
+            for (auto const& c : buffer) {
+                total_weight += c.weight;
+            }
+
+            T weight_so_far = 0;
+            T weight_limit = get_weight_limit(0, total_weight, compression);
+            centroid current = buffer.front();
+            for (size_t i = 1, end = buffer.size(); i < end; ++i) {
+                centroid const& next = buffer[i];
+                if (weight_so_far + current.weight + next.weight <= weight_limit) {
+                    current.weight += next.weight;
+                    current.mean += (next.mean - current.mean) * next.weight / current.weight;
+                }
+                else {
+                    weight_so_far += current.weight;
+                    centroids.push_back(current);
+                    weight_limit = get_weight_limit(weight_so_far, total_weight, compression);
+                    current = next;
+                }
+            }
+            centroids.push_back(current);
+            buffer.clear();
+        }
+
+        T const compression;
+        size_t const buffer_capacity;
+
+        std::vector<centroid> centroids; // sorted by the mean
+        std::vector<centroid> buffer;
+
+        T total_weight = 0;
+        T min = std::numeric_limits<T>::infinity();
+        T max = -std::numeric_limits<T>::infinity();
+    };
+
+#if TUC_HAS_EXECUTION_POLICY
+    // Parallel versions of the above, for large ranges
+
+    template <typename Iterator, typename T = double, typename ExecutionPolicy = std::execution::parallel_unsequenced_policy>
+    T arithmetic_mean(ExecutionPolicy execution_policy, Iterator begin, Iterator end) {
+        auto const instruction_set = simd_detail::selected_instruction_set(); // not within the algorithm
+        auto const sum = numeric_detail::parallel_reduce(
+            execution_policy, begin, end, numeric_detail::compensated_sum<T>(),
+            [instruction_set](Iterator chunk_begin, Iterator chunk_end) { return numeric_detail::sum<T>(chunk_begin, chunk_end, instruction_set); },
+            std::plus<>()
+        );
+        return sum.get() / std::distance(begin, end);
+    }
+
+    template <typename Iterator, typename T = double, typename ExecutionPolicy = std::execution::parallel_unsequenced_policy>
+    T geometric_mean(ExecutionPolicy execution_policy, Iterator begin, Iterator end) {
+        auto const product = numeric_detail::parallel_reduce(
+            execution_policy, begin, end, numeric_detail::scaled_product<T>(),
+            [](Iterator chunk_begin, Iterator chunk_end) { return numeric_detail::product<T>(chunk_begin, chunk_end); },
+            std::multiplies<>()
+        );
+        return product.root(std::distance(begin, end));
+    }
+
+    template <typename Iterator, typename T = double, typename P = double, typename ExecutionPolicy = std::execution::parallel_unsequenced_policy>
+    T power_mean(ExecutionPolicy execution_policy, Iterator begin, Iterator end, P p) {
+        if (p == 0) {
+            return tuc::geometric_mean(execution_policy, begin, end);
+        }
+        if (p == 1) {
+            return tuc::arithmetic_mean<Iterator, T>(execution_policy, begin, end);
+        }
+        p = power_mean_detail::limit(p);
+        numeric_detail::power<T, P> const power(p);
+        auto const sum = numeric_detail::parallel_reduce(
+            execution_policy, begin, end, numeric_detail::compensated_sum<T>(),
+            [power](Iterator chunk_begin, Iterator chunk_end) { return numeric_detail::sum<T>(chunk_begin, chunk_end, power); },
+            std::plus<>()
+        );
+        auto const result = std::pow(sum.get() / std::distance(begin, end), 1.0 / p);
         if (std::isinf(result)) {
-            return *std::max_element(begin, end);
+            return *std::max_element(execution_policy, begin, end);
         }
         return result;
     }
+#endif // TUC_HAS_EXECUTION_POLICY
 
 }
@@ -0,0 +1,1136 @@
+#pragma once
+
+// To be included only via tuc/numeric.hpp
+
+#include "simd_detail.hpp"
+#include "execution_policy_detail.hpp"
+#include <algorithm> // std::min, std::max
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <cstring> // std::memcpy
+#include <limits>
+#include <type_traits>
+#include <assert.h>
+#include <iterator>
+#include <vector>
+
+namespace tuc
+{
+    namespace numeric_detail
+    {
+        // The high half of the double-width product
+        template <typename U>
+        U multiply_high(U a, U b) {
+            static_assert(std::is_unsigned<U>::value, "Unsigned type required");
+            constexpr int bits = std::numeric_limits<U>::digits;
+            if constexpr (bits <= 32) {
+                return static_cast<U>((static_cast<uint64_t>(a) * b) >> bits);
+            }
+            else {
+                static_assert(bits == 64, "Unexpected integer size");
+#ifdef __SIZEOF_INT128__
+                __extension__ typedef unsigned __int128 uint128;
+                return static_cast<U>((static_cast<uint128>(a) * b) >> 64);
+#else // __SIZEOF_INT128__
+                uint64_t const a_low = a & 0xffffffff, a_high = a >> 32;
+                uint64_t const b_low = b & 0xffffffff, b_high = b >> 32;
+                uint64_t const low_low = a_low * b_low, high_low = a_high * b_low, low_high = a_low * b_high;
+                uint64_t const middle = (low_low >> 32) + (high_low & 0xffffffff) + low_high;
+                return a_high * b_high + (high_low >> 32) + (middle >> 32);
+#endif // __SIZEOF_INT128__
+            }
+        }
+
+        // floor(log2(value)), for value > 0
+        inline int floor_log2(uint64_t value) {
+            assert(value > 0);
+#if defined(__GNUC__) || defined(__clang__)
+            return 63 - __builtin_clzll(value);
+#else // defined(__GNUC__) || defined(__clang__)
+            int result = 0;
+            while (value >>= 1) {
+                ++result;
+            }
+            return result;
+#endif // defined(__GNUC__) || defined(__clang__)
+        }
+
+        // Unsigned division by an invariant integer using multiplication (Granlund & Montgomery, 1994)
+        template <typename U>
+        class unsigned_divider
+        {
+        public:
+            unsigned_divider(U denominator) {
+                static_assert(std::is_unsigned<U>::value, "Unsigned type required");
+                assert(denominator != 0);
+                constexpr int bits = std::numeric_limits<U>::digits;
+
+                int l = 0; // ceil(log2(denominator))
+                while (l < bits && (static_cast<U>(1) << l) < denominator) {
+                    ++l;
+                }
+
+                // multiplier = floor(2^bits * (2^l - denominator) / denominator) + 1, by long division
+                U remainder = static_cast<U>((l < bits ? static_cast<U>(1) << l : 0) - denominator);
+                U quotient = 0;
+                for (int i = 0; i < bits; ++i) {
+                    bool const carry = (remainder >> (bits - 1)) != 0;
+                    remainder = static_cast<U>(remainder << 1);
+                    quotient = static_cast<U>(quotient << 1);
+                    if (carry || remainder >= denominator) {
+                        remainder = static_cast<U>(remainder - denominator);
+                        quotient |= 1;
+                    }
+                }
+                multiplier = static_cast<U>(quotient + 1);
+                shift1 = (std::min)(l, 1);
+                shift2 = (std::max)(l - 1, 0);
+            }
+
+            U divide(U numerator) const {
+                U const t = multiply_high(multiplier, numerator);
+                return static_cast<U>((t + static_cast<U>((numerator - t) >> shift1)) >> shift2);
+            }
+
+        private:
+            U multiplier;
+            int shift1;
+            int shift2;
+        };
+
+        // The scalar formulas, shared by the scalar functions, the batch functions and the scalar fallbacks,
+        // so that all of them give bit-for-bit identical results
+
+        template <typename T>
+        T lerp(T const& v0, T const& v1, double t) {
+            return (1.0 - t) * v0 + t * v1;
+        }
+
+        template <typename T>
+        T clamp(T const& value, T const& low_limit, T const& high_limit) {
+            return (std::max)(low_limit, (std::min)(high_limit, value));
+        }
+
+        template <typename T>
+        T smoothstep_prepare(T const& left_edge, T const& range, T const& v) {
+            return numeric_detail::clamp<T>((v - left_edge) / range, 0, 1);
+        }
+
+        template <typename T>
+        T smoothstep_polynomial(T const& x) {
+            return x * x * (3 - 2 * x);
+        }
+
+        template <typename T>
+        T smootherstep_polynomial(T const& x) {
+            return x * x * x * (x * (x * 6 - 15) + 10);
+        }
+
+        // The generic batch versions
+
+        template <typename T>
+        void lerp(T const* v0_begin, T const* v0_end, T const* v1_begin, T* output, double t) {
+            for (std::ptrdiff_t i = 0, count = v0_end - v0_begin; i < count; ++i) {
+                output[i] = numeric_detail::lerp(v0_begin[i], v1_begin[i], t);
+            }
+        }
+
+        template <typename T>
+        void clamp(T const* begin, T const* end, T* output, T const& low_limit, T const& high_limit) {
+            for (std::ptrdiff_t i = 0, count = end - begin; i < count; ++i) {
+                output[i] = numeric_detail::clamp(begin[i], low_limit, high_limit);
+            }
+        }
+
+        template <typename T>
+        void smoothstep(T const& left_edge, T const& right_edge, T const* begin, T const* end, T* output) {
+            T const range = right_edge - left_edge;
+            for (std::ptrdiff_t i = 0, count = end - begin; i < count; ++i) {
+                output[i] = smoothstep_polynomial(smoothstep_prepare(left_edge, range, begin[i]));
+            }
+        }
+
+        template <typename T>
+        void smootherstep(T const& left_edge, T const& right_edge, T const* begin, T const* end, T* output) {
+            T const range = right_edge - left_edge;
+            for (std::ptrdiff_t i = 0, count = end - begin; i < count; ++i) {
+                output[i] = smootherstep_polynomial(smoothstep_prepare(left_edge, range, begin[i]));
+            }
+        }
+
+        // The SIMD kernels for float: each processes as many full vectors as possible, and returns the
+        // number of elements processed. The operations are performed in the same order as in the scalar
+        // formulas above (and min/max are done using the same comparisons, so that NaNs behave the same).
+
+#ifdef TUC_SIMD_X86
+        namespace sse2
+        {
+            inline __m128 clamp(__m128 value, __m128 low_limit, __m128 high_limit) {
+                return _mm_max_ps(_mm_min_ps(value, high_limit), low_limit);
+            }
+
+            inline __m128 smoothstep_prepare(__m128 left_edge, __m128 range, __m128 v) {
+                return clamp(_mm_div_ps(_mm_sub_ps(v, left_edge), range), _mm_set1_ps(0.f), _mm_set1_ps(1.f));
+            }
+
+            inline __m128 smoothstep_polynomial(__m128 x) {
+                return _mm_mul_ps(_mm_mul_ps(x, x), _mm_sub_ps(_mm_set1_ps(3.f), _mm_mul_ps(_mm_set1_ps(2.f), x)));
+            }
+
+            inline __m128 smootherstep_polynomial(__m128 x) {
+                __m128 const x3 = _mm_mul_ps(_mm_mul_ps(x, x), x);
+                __m128 const inner = _mm_sub_ps(_mm_mul_ps(x, _mm_set1_ps(6.f)), _mm_set1_ps(15.f));
+                return _mm_mul_ps(x3, _mm_add_ps(_mm_mul_ps(x, inner), _mm_set1_ps(10.f)));
+            }
+
+            inline __m128d lerp(__m128d v0, __m128d v1, __m128d one_minus_t, __m128d t) {
+                return _mm_add_pd(_mm_mul_pd(one_minus_t, v0), _mm_mul_pd(t, v1));
+            }
+
+            inline size_t lerp(float const* v0, float const* v1, float* output, size_t count, double t) {
+                __m128d const one_minus_t = _mm_set1_pd(1.0 - t), t_ = _mm_set1_pd(t);
+                size_t i = 0;
+                for (; i + 4 <= count; i += 4) {
+                    __m128 const a = _mm_loadu_ps(v0 + i), b = _mm_loadu_ps(v1 + i);
+                    __m128 const low = _mm_cvtpd_ps(lerp(_mm_cvtps_pd(a), _mm_cvtps_pd(b), one_minus_t, t_));
+                    __m128 const high = _mm_cvtpd_ps(lerp(_mm_cvtps_pd(_mm_movehl_ps(a, a)), _mm_cvtps_pd(_mm_movehl_ps(b, b)), one_minus_t, t_));
+                    _mm_storeu_ps(output + i, _mm_movelh_ps(low, high));
+                }
+                return i;
+            }
+
+            inline size_t clamp(float const* input, float* output, size_t count, float low_limit, float high_limit) {
+                __m128 const low = _mm_set1_ps(low_limit), high = _mm_set1_ps(high_limit);
+                size_t i = 0;
+                for (; i + 4 <= count; i += 4) {
+                    _mm_storeu_ps(output + i, clamp(_mm_loadu_ps(input + i), low, high));
+                }
+                return i;
+            }
+
+            inline size_t smoothstep(float left_edge, float range, float const* input, float* output, size_t count) {
+                __m128 const left = _mm_set1_ps(left_edge), r = _mm_set1_ps(range);
+                size_t i = 0;
+                for (; i + 4 <= count; i += 4) {
+                    _mm_storeu_ps(output + i, smoothstep_polynomial(smoothstep_prepare(left, r, _mm_loadu_ps(input + i))));
+                }
+                return i;
+            }
+
+            inline size_t smootherstep(float left_edge, float range, float const* input, float* output, size_t count) {
+                __m128 const left = _mm_set1_ps(left_edge), r = _mm_set1_ps(range);
+                size_t i = 0;
+                for (; i + 4 <= count; i += 4) {
+                    _mm_storeu_ps(output + i, smootherstep_polynomial(smoothstep_prepare(left, r, _mm_loadu_ps(input + i))));
+                }
+                return i;
+            }
+        }
+
+        namespace avx2
+        {
+            TUC_SIMD_TARGET_AVX2 inline __m256 clamp(__m256 value, __m256 low_limit, __m256 high_limit) {
+                return _mm256_max_ps(_mm256_min_ps(value, high_limit), low_limit);
+            }
+
+            TUC_SIMD_TARGET_AVX2 inline __m256 smoothstep_prepare(__m256 left_edge, __m256 range, __m256 v) {
+                return clamp(_mm256_div_ps(_mm256_sub_ps(v, left_edge), range), _mm256_set1_ps(0.f), _mm256_set1_ps(1.f));
+            }
+
+            TUC_SIMD_TARGET_AVX2 inline __m256 smoothstep_polynomial(__m256 x) {
+                return _mm256_mul_ps(_mm256_mul_ps(x, x), _mm256_sub_ps(_mm256_set1_ps(3.f), _mm256_mul_ps(_mm256_set1_ps(2.f), x)));
+            }
+
+            TUC_SIMD_TARGET_AVX2 inline __m256 smootherstep_polynomial(__m256 x) {
+                __m256 const x3 = _mm256_mul_ps(_mm256_mul_ps(x, x), x);
+                __m256 const inner = _mm256_sub_ps(_mm256_mul_ps(x, _mm256_set1_ps(6.f)), _mm256_set1_ps(15.f));
+                return _mm256_mul_ps(x3, _mm256_add_ps(_mm256_mul_ps(x, inner), _mm256_set1_ps(10.f)));
+            }
+
+            TUC_SIMD_TARGET_AVX2 inline __m128 lerp(__m128 v0, __m128 v1, __m256d one_minus_t, __m256d t) {
+                return _mm256_cvtpd_ps(_mm256_add_pd(_mm256_mul_pd(one_minus_t, _mm256_cvtps_pd(v0)), _mm256_mul_pd(t, _mm256_cvtps_pd(v1))));
+            }
+
+            TUC_SIMD_TARGET_AVX2 inline size_t lerp(float const* v0, float const* v1, float* output, size_t count, double t) {
+                __m256d const one_minus_t = _mm256_set1_pd(1.0 - t), t_ = _mm256_set1_pd(t);
+                size_t i = 0;
+                for (; i + 8 <= count; i += 8) {
+                    __m128 const low = lerp(_mm_loadu_ps(v0 + i), _mm_loadu_ps(v1 + i), one_minus_t, t_);
+                    __m128 const high = lerp(_mm_loadu_ps(v0 + i + 4), _mm_loadu_ps(v1 + i + 4), one_minus_t, t_);
+                    _mm256_storeu_ps(output + i, _mm256_insertf128_ps(_mm256_castps128_ps256(low), high, 1));
+                }
+                return i;
+            }
+
+            TUC_SIMD_TARGET_AVX2 inline size_t clamp(float const* input, float* output, size_t count, float low_limit, float high_limit) {
+                __m256 const low = _mm256_set1_ps(low_limit), high = _mm256_set1_ps(high_limit);
+                size_t i = 0;
+                for (; i + 8 <= count; i += 8) {
+                    _mm256_storeu_ps(output + i, clamp(_mm256_loadu_ps(input + i), low, high));
+                }
+                return i;
+            }
+
+            TUC_SIMD_TARGET_AVX2 inline size_t smoothstep(float left_edge, float range, float const* input, float* output, size_t count) {
+                __m256 const left = _mm256_set1_ps(left_edge), r = _mm256_set1_ps(range);
+                size_t i = 0;
+                for (; i + 8 <= count; i += 8) {
+                    _mm256_storeu_ps(output + i, smoothstep_polynomial(smoothstep_prepare(left, r, _mm256_loadu_ps(input + i))));
+                }
+                return i;
+            }
+
+            TUC_SIMD_TARGET_AVX2 inline size_t smootherstep(float left_edge, float range, float const* input, float* output, size_t count) {
+                __m256 const left = _mm256_set1_ps(left_edge), r = _mm256_set1_ps(range);
+                size_t i = 0;
+                for (; i + 8 <= count; i += 8) {
+                    _mm256_storeu_ps(output + i, smootherstep_polynomial(smoothstep_prepare(left, r, _mm256_loadu_ps(input + i))));
+                }
+                return i;
+            }
+        }
+#endif // TUC_SIMD_X86
+
+#ifdef TUC_SIMD_NEON
+        namespace neon
+        {
+            inline float32x4_t clamp(float32x4_t value, float32x4_t low_limit, float32x4_t high_limit) {
+                float32x4_t const m = vbslq_f32(vcltq_f32(value, high_limit), value, high_limit);
+                return vbslq_f32(vcltq_f32(low_limit, m), m, low_limit);
+            }
+
+            inline float32x4_t smoothstep_prepare(float32x4_t left_edge, float32x4_t range, float32x4_t v) {
+                return clamp(vdivq_f32(vsubq_f32(v, left_edge), range), vdupq_n_f32(0.f), vdupq_n_f32(1.f));
+            }
+
+            inline float32x4_t smoothstep_polynomial(float32x4_t x) {
+                return vmulq_f32(vmulq_f32(x, x), vsubq_f32(vdupq_n_f32(3.f), vmulq_f32(vdupq_n_f32(2.f), x)));
+            }
+
+            inline float32x4_t smootherstep_polynomial(float32x4_t x) {
+                float32x4_t const x3 = vmulq_f32(vmulq_f32(x, x), x);
+                float32x4_t const inner = vsubq_f32(vmulq_f32(x, vdupq_n_f32(6.f)), vdupq_n_f32(15.f));
+                return vmulq_f32(x3, vaddq_f32(vmulq_f32(x, inner), vdupq_n_f32(10.f)));
+            }
+
+            inline float64x2_t lerp(float64x2_t v0, float64x2_t v1, float64x2_t one_minus_t, float64x2_t t) {
+                return vaddq_f64(vmulq_f64(one_minus_t, v0), vmulq_f64(t, v1));
+            }
+
+            inline size_t lerp(float const* v0, float const* v1, float* output, size_t count, double t) {
+                float64x2_t const one_minus_t = vdupq_n_f64(1.0 - t), t_ = vdupq_n_f64(t);
+                size_t i = 0;
+                for (; i + 4 <= count; i += 4) {
+                    float32x4_t const a = vld1q_f32(v0 + i), b = vld1q_f32(v1 + i);
+                    float64x2_t const low = lerp(vcvt_f64_f32(vget_low_f32(a)), vcvt_f64_f32(vget_low_f32(b)), one_minus_t, t_);
+                    float64x2_t const high = lerp(vcvt_high_f64_f32(a), vcvt_high_f64_f32(b), one_minus_t, t_);
+                    vst1q_f32(output + i, vcvt_high_f32_f64(vcvt_f32_f64(low), high));
+                }
+                return i;
+            }
+
+            inline size_t clamp(float const* input, float* output, size_t count, float low_limit, float high_limit) {
+                float32x4_t const low = vdupq_n_f32(low_limit), high = vdupq_n_f32(high_limit);
+                size_t i = 0;
+                for (; i + 4 <= count; i += 4) {
+                    vst1q_f32(output + i, clamp(vld1q_f32(input + i), low, high));
+                }
+                return i;
+            }
+
+            inline size_t smoothstep(float left_edge, float range, float const* input, float* output, size_t count) {
+                float32x4_t const left = vdupq_n_f32(left_edge), r = vdupq_n_f32(range);
+                size_t i = 0;
+                for (; i + 4 <= count; i += 4) {
+                    vst1q_f32(output + i, smoothstep_polynomial(smoothstep_prepare(left, r, vld1q_f32(input + i))));
+                }
+                return i;
+            }
+
+            inline size_t smootherstep(float left_edge, float range, float const* input, float* output, size_t count) {
+                float32x4_t const left = vdupq_n_f32(left_edge), r = vdupq_n_f32(range);
+                size_t i = 0;
+                for (; i + 4 <= count; i += 4) {
+                    vst1q_f32(output + i, smootherstep_polynomial(smoothstep_prepare(left, r, vld1q_f32(input + i))));
+                }
+                return i;
+            }
+        }
+#endif // TUC_SIMD_NEON
+
+        // The float batch versions: dispatch to the best available kernel, and finish the rest with the generic version
+
+        inline void lerp(float const* v0_begin, float const* v0_end, float const* v1_begin, float* output, double t) {
+            [[maybe_unused]] size_t const count = v0_end - v0_begin;
+            size_t done = 0;
+            switch (simd_detail::selected_instruction_set()) {
+#ifdef TUC_SIMD_X86
+            case simd_detail::instruction_set::avx2: done = avx2::lerp(v0_begin, v1_begin, output, count, t); break;
+            case simd_detail::instruction_set::sse2: done = sse2::lerp(v0_begin, v1_begin, output, count, t); break;
+#endif // TUC_SIMD_X86
+#ifdef TUC_SIMD_NEON
+            case simd_detail::instruction_set::neon: done = neon::lerp(v0_begin, v1_begin, output, count, t); break;
+#endif // TUC_SIMD_NEON
+            default: break;
+            }
+            numeric_detail::lerp<float>(v0_begin + done, v0_end, v1_begin + done, output + done, t);
+        }
+
+        inline void clamp(float const* begin, float const* end, float* output, float low_limit, float high_limit) {
+            [[maybe_unused]] size_t const count = end - begin;
+            size_t done = 0;
+            switch (simd_detail::selected_instruction_set()) {
+#ifdef TUC_SIMD_X86
+            case simd_detail::instruction_set::avx2: done = avx2::clamp(begin, output, count, low_limit, high_limit); break;
+            case simd_detail::instruction_set::sse2: done = sse2::clamp(begin, output, count, low_limit, high_limit); break;
+#endif // TUC_SIMD_X86
+#ifdef TUC_SIMD_NEON
+            case simd_detail::instruction_set::neon: done = neon::clamp(begin, output, count, low_limit, high_limit); break;
+#endif // TUC_SIMD_NEON
+            default: break;
+            }
+            numeric_detail::clamp<float>(begin + done, end, output + done, low_limit, high_limit);
+        }
+
+        inline void smoothstep(float left_edge, float right_edge, float const* begin, float const* end, float* output) {
+            [[maybe_unused]] size_t const count = end - begin;
+            [[maybe_unused]] float const range = right_edge - left_edge;
+            size_t done = 0;
+            switch (simd_detail::selected_instruction_set()) {
+#ifdef TUC_SIMD_X86
+            case simd_detail::instruction_set::avx2: done = avx2::smoothstep(left_edge, range, begin, output, count); break;
+            case simd_detail::instruction_set::sse2: done = sse2::smoothstep(left_edge, range, begin, output, count); break;
+#endif // TUC_SIMD_X86
+#ifdef TUC_SIMD_NEON
+            case simd_detail::instruction_set::neon: done = neon::smoothstep(left_edge, range, begin, output, count); break;
+#endif // TUC_SIMD_NEON
+            default: break;
+            }
+            numeric_detail::smoothstep<float>(left_edge, right_edge, begin + done, end, output + done);
+        }
+
+        inline void smootherstep(float left_edge, float right_edge, float const* begin, float const* end, float* output) {
+            [[maybe_unused]] size_t const count = end - begin;
+            [[maybe_unused]] float const range = right_edge - left_edge;
+            size_t done = 0;
+            switch (simd_detail::selected_instruction_set()) {
+#ifdef TUC_SIMD_X86
+            case simd_detail::instruction_set::avx2: done = avx2::smootherstep(left_edge, range, begin, output, count); break;
+            case simd_detail::instruction_set::sse2: done = sse2::smootherstep(left_edge, range, begin, output, count); break;
+#endif // TUC_SIMD_X86
+#ifdef TUC_SIMD_NEON
+            case simd_detail::instruction_set::neon: done = neon::smootherstep(left_edge, range, begin, output, count); break;
+#endif // TUC_SIMD_NEON
+            default: break;
+            }
+            numeric_detail::smootherstep<float>(left_edge, right_edge, begin + done, end, output + done);
+        }
+
+        // Summation with Neumaier's compensation: the rounding error of each addition is accumulated
+        // separately, so that the result does not degrade as the number of values grows
+        template <typename T>
+        class compensated_sum
+        {
+        public:
+            compensated_sum(T const& value = 0)
+                : sum(value)
+            {}
+
+            compensated_sum& operator+=(T const& value) {
+                T const t = sum + value;
+                if (std::abs(sum) >= std::abs(value)) {
+                    compensation += (sum - t) + value;
+                }
+                else {
+                    compensation += (value - t) + sum;
+                }
+                sum = t;
+                return *this;
+            }
+
+            compensated_sum& operator+=(compensated_sum const& that) {
+                *this += that.sum;
+                compensation += that.compensation;
+                return *this;
+            }
+
+            friend compensated_sum operator+(compensated_sum lhs, compensated_sum const& rhs) {
+                return lhs += rhs;
+            }
+
+            T get() const {
+                if constexpr (std::is_floating_point<T>::value) {
+                    if (std::isinf(sum)) {
+                        return sum; // the compensation would be NaN
+                    }
+                }
+                return sum + compensation;
+            }
+
+        private:
+            T sum;
+            T compensation = 0;
+        };
+
+        // A product that cannot overflow or underflow: the binary exponent is tracked separately.
+        // As long as the plain product would not have overflowed or underflowed, the result is the
+        // same, because scaling by powers of two is exact.
+        template <typename T>
+        class scaled_product
+        {
+        public:
+            scaled_product(T const& value = 1) {
+                mantissa = std::frexp(value, &exponent);
+            }
+
+            scaled_product& operator*=(T const& value) {
+                int e = 0;
+                mantissa *= std::frexp(value, &e);
+                exponent += e;
+                normalize();
+                return *this;
+            }
+
+            scaled_product& operator*=(scaled_product const& that) {
+                int e1 = 0, e2 = 0;
+                mantissa = std::frexp(mantissa, &e1) * std::frexp(that.mantissa, &e2);
+                exponent += e1 + e2 + that.exponent;
+                return *this;
+            }
+
+            friend scaled_product operator*(scaled_product lhs, scaled_product const& rhs) {
+                return lhs *= rhs;
+            }
+
+            // Returns the n-th root of the product
+            T root(size_t n) const {
+                T const product = std::ldexp(mantissa, exponent);
+                if (std::isnormal(product) || !std::isnormal(mantissa)) {
+                    return std::pow(product, 1.0 / n);
+                }
+                return std::pow(mantissa, 1.0 / n) * std::exp2(static_cast<double>(exponent) / n);
+            }
+
+        private:
+            void normalize() {
+                if (std::abs(mantissa) < min_mantissa && mantissa != 0) {
+                    int e = 0;
+                    mantissa = std::frexp(mantissa, &e);
+                    exponent += e;
+                }
+            }
+
+            // frexp() returns mantissas in [0.5, 1), so the product stays well within range until normalized
+            static constexpr T min_mantissa = static_cast<T>(1e-30);
+
+            T mantissa;
+            int exponent = 0;
+        };
+
+        // x^p, without calling pow() for the most common values of p
+        template <typename T, typename P>
+        class power
+        {
+        public:
+            power(P p)
+                : p(p)
+                , op(get_operation(p))
+            {}
+
+            T operator()(T const& x) const {
+                switch (op) {
+                case operation::identity: return x;
+                case operation::square: return x * x;
+                case operation::reciprocal: return 1 / x;
+                case operation::square_root: return std::sqrt(x);
+                default: return std::pow(x, p);
+                }
+            }
+
+        private:
+            enum struct operation { identity, square, reciprocal, square_root, generic };
+
+            static operation get_operation(P p) {
+                return p == 1 ? operation::identity
+                    : p == 2 ? operation::square
+                    : p == -1 ? operation::reciprocal
+                    : p == 0.5 ? operation::square_root
+                    : operation::generic;
+            }
+
+            P const p;
+            operation const op;
+        };
+
+        template <typename Iterator>
+        using iterator_value_t = typename std::iterator_traits<Iterator>::value_type;
+
+        // Only the cases that can be detected in C++17
+        template <typename Iterator>
+        constexpr bool is_contiguous_iterator_v =
+            std::is_pointer<Iterator>::value
+            || std::is_same<Iterator, typename std::vector<iterator_value_t<Iterator>>::iterator>::value
+            || std::is_same<Iterator, typename std::vector<iterator_value_t<Iterator>>::const_iterator>::value;
+
+        // The SIMD summation kernels: compensated summation in each lane, with the lanes finally
+        // added to `result`. Return the number of elements processed.
+
+#ifdef TUC_SIMD_X86
+        namespace sse2
+        {
+            inline void add(__m128d& sum, __m128d& compensation, __m128d value) {
+                __m128d const abs_mask = _mm_castsi128_pd(_mm_set1_epi64x(0x7fffffffffffffffLL));
+                __m128d const t = _mm_add_pd(sum, value);
+                __m128d const sum_is_larger = _mm_cmpge_pd(_mm_and_pd(sum, abs_mask), _mm_and_pd(value, abs_mask));
+                __m128d const if_sum_is_larger = _mm_add_pd(_mm_sub_pd(sum, t), value);
+                __m128d const otherwise = _mm_add_pd(_mm_sub_pd(value, t), sum);
+                compensation = _mm_add_pd(compensation, _mm_or_pd(_mm_and_pd(sum_is_larger, if_sum_is_larger), _mm_andnot_pd(sum_is_larger, otherwise)));
+                sum = t;
+            }
+
+            inline void add_lanes(__m128d sum, __m128d compensation, compensated_sum<double>& result) {
+                double s[2], c[2];
+                _mm_storeu_pd(s, sum);
+                _mm_storeu_pd(c, compensation);
+                for (int i = 0; i < 2; ++i) {
+                    result += s[i];
+                    result += c[i];
+                }
+            }
+
+            inline size_t sum(double const* input, size_t count, compensated_sum<double>& result) {
+                __m128d sum = _mm_setzero_pd(), compensation = _mm_setzero_pd();
+                size_t i = 0;
+                for (; i + 2 <= count; i += 2) {
+                    add(sum, compensation, _mm_loadu_pd(input + i));
+                }
+                add_lanes(sum, compensation, result);
+                return i;
+            }
+
+            inline size_t sum(float const* input, size_t count, compensated_sum<double>& result) {
+                __m128d sum = _mm_setzero_pd(), compensation = _mm_setzero_pd();
+                size_t i = 0;
+                for (; i + 2 <= count; i += 2) {
+                    add(sum, compensation, _mm_cvtps_pd(_mm_castsi128_ps(_mm_loadl_epi64(reinterpret_cast<__m128i const*>(input + i)))));
+                }
+                add_lanes(sum, compensation, result);
+                return i;
+            }
+        }
+
+        namespace avx2
+        {
+            TUC_SIMD_TARGET_AVX2 inline void add(__m256d& sum, __m256d& compensation, __m256d value) {
+                __m256d const abs_mask = _mm256_castsi256_pd(_mm256_set1_epi64x(0x7fffffffffffffffLL));
+                __m256d const t = _mm256_add_pd(sum, value);
+                __m256d const sum_is_larger = _mm256_cmp_pd(_mm256_and_pd(sum, abs_mask), _mm256_and_pd(value, abs_mask), _CMP_GE_OQ);
+                __m256d const if_sum_is_larger = _mm256_add_pd(_mm256_sub_pd(sum, t), value);
+                __m256d const otherwise = _mm256_add_pd(_mm256_sub_pd(value, t), sum);
+                compensation = _mm256_add_pd(compensation, _mm256_blendv_pd(otherwise, if_sum_is_larger, sum_is_larger));
+                sum = t;
+            }
+
+            TUC_SIMD_TARGET_AVX2 inline void add_lanes(__m256d sum, __m256d compensation, compensated_sum<double>& result) {
+                double s[4], c[4];
+                _mm256_storeu_pd(s, sum);
+                _mm256_storeu_pd(c, compensation);
+                for (int i = 0; i < 4; ++i) {
+                    result += s[i];
+                    result += c[i];
+                }
+            }
+
+            TUC_SIMD_TARGET_AVX2 inline size_t sum(double const* input, size_t count, compensated_sum<double>& result) {
+                __m256d sum = _mm256_setzero_pd(), compensation = _mm256_setzero_pd();
+                size_t i = 0;
+                for (; i + 4 <= count; i += 4) {
+                    add(sum, compensation, _mm256_loadu_pd(input + i));
+                }
+                add_lanes(sum, compensation, result);
+                return i;
+            }
+
+            TUC_SIMD_TARGET_AVX2 inline size_t sum(float const* input, size_t count, compensated_sum<double>& result) {
+                __m256d sum = _mm256_setzero_pd(), compensation = _mm256_setzero_pd();
+                size_t i = 0;
+                for (; i + 4 <= count; i += 4) {
+                    add(sum, compensation, _mm256_cvtps_pd(_mm_loadu_ps(input + i)));
+                }
+                add_lanes(sum, compensation, result);
+                return i;
+            }
+        }
+#endif // TUC_SIMD_X86
+
+#ifdef TUC_SIMD_NEON
+        namespace neon
+        {
+            inline void add(float64x2_t& sum, float64x2_t& compensation, float64x2_t value) {
+                float64x2_t const t = vaddq_f64(sum, value);
+                uint64x2_t const sum_is_larger = vcgeq_f64(vabsq_f64(sum), vabsq_f64(value));
+                float64x2_t const if_sum_is_larger = vaddq_f64(vsubq_f64(sum, t), value);
+                float64x2_t const otherwise = vaddq_f64(vsubq_f64(value, t), sum);
+                compensation = vaddq_f64(compensation, vbslq_f64(sum_is_larger, if_sum_is_larger, otherwise));
+                sum = t;
+            }
+
+            inline void add_lanes(float64x2_t sum, float64x2_t compensation, compensated_sum<double>& result) {
+                double s[2], c[2];
+                vst1q_f64(s, sum);
+                vst1q_f64(c, compensation);
+                for (int i = 0; i < 2; ++i) {
+                    result += s[i];
+                    result += c[i];
+                }
+            }
+
+            inline size_t sum(double const* input, size_t count, compensated_sum<double>& result) {
+                float64x2_t sum = vdupq_n_f64(0), compensation = vdupq_n_f64(0);
+                size_t i = 0;
+                for (; i + 2 <= count; i += 2) {
+                    add(sum, compensation, vld1q_f64(input + i));
+                }
+                add_lanes(sum, compensation, result);
+                return i;
+            }
+
+            inline size_t sum(float const* input, size_t count, compensated_sum<double>& result) {
+                float64x2_t sum = vdupq_n_f64(0), compensation = vdupq_n_f64(0);
+                size_t i = 0;
+                for (; i + 2 <= count; i += 2) {
+                    add(sum, compensation, vcvt_f64_f32(vld1_f32(input + i)));
+                }
+                add_lanes(sum, compensation, result);
+                return i;
+            }
+        }
+#endif // TUC_SIMD_NEON
+
+        template <typename Input>
+        compensated_sum<double> simd_sum(Input const* input, size_t count, simd_detail::instruction_set instruction_set) {
+            compensated_sum<double> result;
+            size_t done = 0;
+            switch (instruction_set) {
+#ifdef TUC_SIMD_X86
+            case simd_detail::instruction_set::avx2: done = avx2::sum(input, count, result); break;
+            case simd_detail::instruction_set::sse2: done = sse2::sum(input, count, result); break;
+#endif // TUC_SIMD_X86
+#ifdef TUC_SIMD_NEON
+            case simd_detail::instruction_set::neon: done = neon::sum(input, count, result); break;
+#endif // TUC_SIMD_NEON
+            default: break;
+            }
+            for (size_t i = done; i < count; ++i) {
+                result += static_cast<double>(input[i]);
+            }
+            return result;
+        }
+
+        template <typename T, typename Iterator, typename Transform>
+        compensated_sum<T> sum(Iterator begin, Iterator end, Transform transform) {
+            compensated_sum<T> result;
+            for (Iterator i = begin; i != end; ++i) {
+                result += static_cast<T>(transform(*i));
+            }
+            return result;
+        }
+
+        // Pass the instruction set when summing within a std::execution::par_unseq algorithm, which
+        // must not take the lock that guards the initialization of selected_instruction_set()
+        template <typename T, typename Iterator>
+        compensated_sum<T> sum(Iterator begin, Iterator end, simd_detail::instruction_set instruction_set = simd_detail::selected_instruction_set()) {
+            using V = iterator_value_t<Iterator>;
+            if constexpr (std::is_same<T, double>::value && (std::is_same<V, double>::value || std::is_same<V, float>::value) && is_contiguous_iterator_v<Iterator>) {
+                if (begin == end) {
+                    return compensated_sum<T>();
+                }
+                return simd_sum(&*begin, static_cast<size_t>(end - begin), instruction_set);
+            }
+            else {
+                return sum<T>(begin, end, [](auto const& value) { return value; });
+            }
+        }
+
+        template <typename T, typename Iterator>
+        scaled_product<T> product(Iterator begin, Iterator end) {
+            scaled_product<T> result;
+            for (Iterator i = begin; i != end; ++i) {
+                result *= static_cast<T>(*i);
+            }
+            return result;
+        }
+
+        // The range of integral Output, as a half-open interval [lower, upper) of floating-point
+        // values. Both limits are powers of two (or zero), so they are exactly representable.
+        template <typename Output, typename Input>
+        Input get_round_upper_limit() {
+            return std::ldexp(Input(1), std::numeric_limits<Output>::digits);
+        }
+
+        template <typename Output, typename Input>
+        Input get_round_lower_limit() {
+            return std::is_signed<Output>::value ? -get_round_upper_limit<Output, Input>() : Input(0);
+        }
+
+        // Is the already rounded value representable as Output? (NaN is not.)
+        template <typename Output, typename Input>
+        bool is_representable(Input rounded) {
+            return rounded >= get_round_lower_limit<Output, Input>() && rounded < get_round_upper_limit<Output, Input>();
+        }
+
+        template <typename Output, typename Input>
+        Output saturate(Input rounded) {
+            if (rounded >= get_round_upper_limit<Output, Input>()) {
+                return (std::numeric_limits<Output>::max)();
+            }
+            if (rounded < get_round_lower_limit<Output, Input>()) {
+                return std::numeric_limits<Output>::lowest();
+            }
+            return rounded == rounded ? static_cast<Output>(rounded) : Output(0);
+        }
+
+        // The output types for which there are SIMD kernels converting from float
+        template <typename Output>
+        constexpr bool has_simd_round_v =
+            std::is_same<Output, int32_t>::value
+            || std::is_same<Output, int16_t>::value
+            || std::is_same<Output, uint16_t>::value
+            || std::is_same<Output, uint8_t>::value;
+
+        // The SIMD rounding kernels: round half away from zero (like std::round), and convert to
+        // Output. If `saturate` is false, stop before the first vector containing a value that is
+        // not representable, so that the caller can deal with it. Return the number of elements
+        // processed.
+
+#ifdef TUC_SIMD_X86
+        namespace sse2
+        {
+            inline __m128 select(__m128 mask, __m128 if_true, __m128 if_false) {
+                return _mm_or_ps(_mm_and_ps(mask, if_true), _mm_andnot_ps(mask, if_false));
+            }
+
+            inline __m128 round(__m128 x) {
+                __m128 const sign_mask = _mm_set1_ps(-0.f);
+                // From 2^23 up, there is no fractional part (and the values may not fit in an int32)
+                __m128 const may_have_fraction = _mm_cmplt_ps(_mm_andnot_ps(sign_mask, x), _mm_set1_ps(8388608.f));
+                __m128 const truncated = select(may_have_fraction, _mm_cvtepi32_ps(_mm_cvttps_epi32(x)), x);
+                __m128 const round_away = _mm_cmpge_ps(_mm_andnot_ps(sign_mask, _mm_sub_ps(x, truncated)), _mm_set1_ps(0.5f));
+                __m128 const one_with_sign_of_x = _mm_or_ps(_mm_set1_ps(1.f), _mm_and_ps(sign_mask, x));
+                return _mm_add_ps(truncated, _mm_and_ps(round_away, one_with_sign_of_x));
+            }
+
+            inline void store(int32_t* output, __m128i v) {
+                _mm_storeu_si128(reinterpret_cast<__m128i*>(output), v);
+            }
+
+            inline void store(int16_t* output, __m128i v) {
+                _mm_storel_epi64(reinterpret_cast<__m128i*>(output), _mm_packs_epi32(v, v));
+            }
+
+            inline void store(uint16_t* output, __m128i v) {
+                // There's no unsigned 32-to-16-bit pack in SSE2, so shift to the signed range and back
+                __m128i const shifted = _mm_sub_epi32(v, _mm_set1_epi32(32768));
+                _mm_storel_epi64(reinterpret_cast<__m128i*>(output), _mm_add_epi16(_mm_packs_epi32(shifted, shifted), _mm_set1_epi16(-32768)));
+            }
+
+            inline void store(uint8_t* output, __m128i v) {
+                __m128i const v16 = _mm_packs_epi32(v, v);
+                int32_t const v8 = _mm_cvtsi128_si32(_mm_packus_epi16(v16, v16));
+                std::memcpy(output, &v8, sizeof v8);
+            }
+
+            template <typename Output>
+            size_t round(float const* input, Output* output, size_t count, bool saturate) {
+                __m128 const lower = _mm_set1_ps(get_round_lower_limit<Output, float>());
+                __m128 const upper = _mm_set1_ps(get_round_upper_limit<Output, float>());
+                __m128i const lowest = _mm_set1_epi32(std::numeric_limits<Output>::lowest());
+                __m128i const max = _mm_set1_epi32((std::numeric_limits<Output>::max)());
+                size_t i = 0;
+                for (; i + 4 <= count; i += 4) {
+                    __m128 const rounded = round(_mm_loadu_ps(input + i));
+                    __m128 const too_low = _mm_cmplt_ps(rounded, lower);
+                    __m128 const too_high = _mm_cmpge_ps(rounded, upper);
+                    __m128 const representable = _mm_and_ps(_mm_cmpge_ps(rounded, lower), _mm_cmplt_ps(rounded, upper));
+                    if (!saturate && _mm_movemask_ps(representable) != 0xf) {
+                        break;
+                    }
+                    __m128i v = _mm_and_si128(_mm_cvttps_epi32(rounded), _mm_castps_si128(representable)); // NaN -> 0
+                    v = _mm_or_si128(v, _mm_and_si128(_mm_castps_si128(too_low), lowest));
+                    v = _mm_or_si128(v, _mm_and_si128(_mm_castps_si128(too_high), max));
+                    store(output + i, v);
+                }
+                return i;
+            }
+        }
+
+        namespace avx2
+        {
+            TUC_SIMD_TARGET_AVX2 inline __m256 round(__m256 x) {
+                __m256 const sign_mask = _mm256_set1_ps(-0.f);
+                __m256 const truncated = _mm256_round_ps(x, _MM_FROUND_TO_ZERO | _MM_FROUND_NO_EXC);
+                __m256 const round_away = _mm256_cmp_ps(_mm256_andnot_ps(sign_mask, _mm256_sub_ps(x, truncated)), _mm256_set1_ps(0.5f), _CMP_GE_OQ);
+                __m256 const one_with_sign_of_x = _mm256_or_ps(_mm256_set1_ps(1.f), _mm256_and_ps(sign_mask, x));
+                return _mm256_add_ps(truncated, _mm256_and_ps(round_away, one_with_sign_of_x));
+            }
+
+            TUC_SIMD_TARGET_AVX2 inline void store(int32_t* output, __m256i v) {
+                _mm256_storeu_si256(reinterpret_cast<__m256i*>(output), v);
+            }
+
+            TUC_SIMD_TARGET_AVX2 inline void store(int16_t* output, __m256i v) {
+                _mm_storeu_si128(reinterpret_cast<__m128i*>(output), _mm_packs_epi32(_mm256_castsi256_si128(v), _mm256_extracti128_si256(v, 1)));
+            }
+
+            TUC_SIMD_TARGET_AVX2 inline void store(uint16_t* output, __m256i v) {
+                _mm_storeu_si128(reinterpret_cast<__m128i*>(output), _mm_packus_epi32(_mm256_castsi256_si128(v), _mm256_extracti128_si256(v, 1)));
+            }
+
+            TUC_SIMD_TARGET_AVX2 inline void store(uint8_t* output, __m256i v) {
+                __m128i const v16 = _mm_packs_epi32(_mm256_castsi256_si128(v), _mm256_extracti128_si256(v, 1));
+                _mm_storel_epi64(reinterpret_cast<__m128i*>(output), _mm_packus_epi16(v16, v16));
+            }
+
+            template <typename Output>
+            TUC_SIMD_TARGET_AVX2 size_t round(float const* input, Output* output, size_t count, bool saturate) {
+                __m256 const lower = _mm256_set1_ps(get_round_lower_limit<Output, float>());
+                __m256 const upper = _mm256_set1_ps(get_round_upper_limit<Output, float>());
+                __m256i const lowest = _mm256_set1_epi32(std::numeric_limits<Output>::lowest());
+                __m256i const max = _mm256_set1_epi32((std::numeric_limits<Output>::max)());
+                size_t i = 0;
+                for (; i + 8 <= count; i += 8) {
+                    __m256 const rounded = round(_mm256_loadu_ps(input + i));
+                    __m256 const too_low = _mm256_cmp_ps(rounded, lower, _CMP_LT_OQ);
+                    __m256 const too_high = _mm256_cmp_ps(rounded, upper, _CMP_GE_OQ);
+                    __m256 const representable = _mm256_and_ps(_mm256_cmp_ps(rounded, lower, _CMP_GE_OQ), _mm256_cmp_ps(rounded, upper, _CMP_LT_OQ));
+                    if (!saturate && _mm256_movemask_ps(representable) != 0xff) {
+                        break;
+                    }
+                    __m256i v = _mm256_and_si256(_mm256_cvttps_epi32(rounded), _mm256_castps_si256(representable)); // NaN -> 0
+                    v = _mm256_or_si256(v, _mm256_and_si256(_mm256_castps_si256(too_low), lowest));
+                    v = _mm256_or_si256(v, _mm256_and_si256(_mm256_castps_si256(too_high), max));
+                    store(output + i, v);
+                }
+                return i;
+            }
+        }
+#endif // TUC_SIMD_X86
+
+#ifdef TUC_SIMD_NEON
+        namespace neon
+        {
+            // The conversions below saturate, and map NaN to zero
+            inline void store(int32_t* output, int32x4_t v) {
+                vst1q_s32(output, v);
+            }
+
+            inline void store(int16_t* output, int32x4_t v) {
+                vst1_s16(output, vqmovn_s32(v));
+            }
+
+            inline void store(uint16_t* output, int32x4_t v) {
+                vst1_u16(output, vqmovun_s32(v));
+            }
+
+            inline void store(uint8_t* output, int32x4_t v) {
+                uint16x4_t const v16 = vqmovun_s32(v);
+                uint32_t const v8 = vget_lane_u32(vreinterpret_u32_u8(vqmovn_u16(vcombine_u16(v16, v16))), 0);
+                std::memcpy(output, &v8, sizeof v8);
+            }
+
+            template <typename Output>
+            size_t round(float const* input, Output* output, size_t count, bool saturate) {
+                float32x4_t const lower = vdupq_n_f32(get_round_lower_limit<Output, float>());
+                float32x4_t const upper = vdupq_n_f32(get_round_upper_limit<Output, float>());
+                size_t i = 0;
+                for (; i + 4 <= count; i += 4) {
+                    float32x4_t const x = vld1q_f32(input + i);
+                    if (!saturate) {
+                        float32x4_t const rounded = vrndaq_f32(x);
+                        uint32x4_t const representable = vandq_u32(vcgeq_f32(rounded, lower), vcltq_f32(rounded, upper));
+                        if (vminvq_u32(representable) == 0) {
+                            break;
+                        }
+                    }
+                    store(output + i, vcvtaq_s32_f32(x));
+                }
+                return i;
+            }
+        }
+#endif // TUC_SIMD_NEON
+
+        template <typename Output>
+        size_t simd_round([[maybe_unused]] float const* input, [[maybe_unused]] Output* output, [[maybe_unused]] size_t count, [[maybe_unused]] bool saturate) {
+            switch (simd_detail::selected_instruction_set()) {
+#ifdef TUC_SIMD_X86
+            case simd_detail::instruction_set::avx2: return avx2::round(input, output, count, saturate);
+            case simd_detail::instruction_set::sse2: return sse2::round(input, output, count, saturate);
+#endif // TUC_SIMD_X86
+#ifdef TUC_SIMD_NEON
+            case simd_detail::instruction_set::neon: return neon::round(input, output, count, saturate);
+#endif // TUC_SIMD_NEON
+            default: return 0;
+            }
+        }
+
+        // The SIMD prefix sum kernels: add up `input` (inclusively or exclusively) into `output`,
+        // starting from `carry`, which is updated to the total. Unsigned types are used so that any
+        // overflow wraps around. Return the number of elements processed.
+
+#ifdef TUC_SIMD_X86
+        namespace sse2
+        {
+            inline size_t scan(uint32_t const* input, uint32_t* output, size_t count, uint32_t& carry, bool inclusive) {
+                __m128i c = _mm_set1_epi32(static_cast<int>(carry));
+                size_t i = 0;
+                for (; i + 4 <= count; i += 4) {
+                    __m128i const x = _mm_loadu_si128(reinterpret_cast<__m128i const*>(input + i));
+                    __m128i sum = _mm_add_epi32(x, _mm_slli_si128(x, 4));
+                    sum = _mm_add_epi32(sum, _mm_slli_si128(sum, 8));
+                    sum = _mm_add_epi32(sum, c);
+                    _mm_storeu_si128(reinterpret_cast<__m128i*>(output + i), inclusive ? sum : _mm_sub_epi32(sum, x));
+                    c = _mm_shuffle_epi32(sum, _MM_SHUFFLE(3, 3, 3, 3));
+                }
+                carry = static_cast<uint32_t>(_mm_cvtsi128_si32(c));
+                return i;
+            }
+
+            inline size_t scan(uint64_t const* input, uint64_t* output, size_t count, uint64_t& carry, bool inclusive) {
+                __m128i c = _mm_set1_epi64x(static_cast<long long>(carry));
+                size_t i = 0;
+                for (; i + 2 <= count; i += 2) {
+                    __m128i const x = _mm_loadu_si128(reinterpret_cast<__m128i const*>(input + i));
+                    __m128i sum = _mm_add_epi64(x, _mm_slli_si128(x, 8));
+                    sum = _mm_add_epi64(sum, c);
+                    _mm_storeu_si128(reinterpret_cast<__m128i*>(output + i), inclusive ? sum : _mm_sub_epi64(sum, x));
+                    c = _mm_shuffle_epi32(sum, _MM_SHUFFLE(3, 2, 3, 2));
+                }
+                _mm_storel_epi64(reinterpret_cast<__m128i*>(&carry), c);
+                return i;
+            }
+        }
+
+        namespace avx2
+        {
+            TUC_SIMD_TARGET_AVX2 inline size_t scan(uint32_t const* input, uint32_t* output, size_t count, uint32_t& carry, bool inclusive) {
+                __m256i c = _mm256_set1_epi32(static_cast<int>(carry));
+                size_t i = 0;
+                for (; i + 8 <= count; i += 8) {
+                    __m256i const x = _mm256_loadu_si256(reinterpret_cast<__m256i const*>(input + i));
+                    // The shifts work within each 128-bit half, so finally add the total of the lower half to the upper one
+                    __m256i sum = _mm256_add_epi32(x, _mm256_slli_si256(x, 4));
+                    sum = _mm256_add_epi32(sum, _mm256_slli_si256(sum, 8));
+                    sum = _mm256_add_epi32(sum, _mm256_shuffle_epi32(_mm256_permute2x128_si256(sum, sum, 0x08), _MM_SHUFFLE(3, 3, 3, 3)));
+                    sum = _mm256_add_epi32(sum, c);
+                    _mm256_storeu_si256(reinterpret_cast<__m256i*>(output + i), inclusive ? sum : _mm256_sub_epi32(sum, x));
+                    c = _mm256_permutevar8x32_epi32(sum, _mm256_set1_epi32(7));
+                }
+                carry = static_cast<uint32_t>(_mm_cvtsi128_si32(_mm256_castsi256_si128(c)));
+                return i;
+            }
+
+            TUC_SIMD_TARGET_AVX2 inline size_t scan(uint64_t const* input, uint64_t* output, size_t count, uint64_t& carry, bool inclusive) {
+                __m256i c = _mm256_set1_epi64x(static_cast<long long>(carry));
+                size_t i = 0;
+                for (; i + 4 <= count; i += 4) {
+                    __m256i const x = _mm256_loadu_si256(reinterpret_cast<__m256i const*>(input + i));
+                    __m256i sum = _mm256_add_epi64(x, _mm256_slli_si256(x, 8));
+                    sum = _mm256_add_epi64(sum, _mm256_shuffle_epi32(_mm256_permute2x128_si256(sum, sum, 0x08), _MM_SHUFFLE(3, 2, 3, 2)));
+                    sum = _mm256_add_epi64(sum, c);
+                    _mm256_storeu_si256(reinterpret_cast<__m256i*>(output + i), inclusive ? sum : _mm256_sub_epi64(sum, x));
+                    c = _mm256_permute4x64_epi64(sum, _MM_SHUFFLE(3, 3, 3, 3));
+                }
+                _mm_storel_epi64(reinterpret_cast<__m128i*>(&carry), _mm256_castsi256_si128(c));
+                return i;
+            }
+        }
+#endif // TUC_SIMD_X86
+
+#ifdef TUC_SIMD_NEON
+        namespace neon
+        {
+            inline size_t scan(uint32_t const* input, uint32_t* output, size_t count, uint32_t& carry, bool inclusive) {
+                uint32x4_t const zero = vdupq_n_u32(0);
+                uint32x4_t c = vdupq_n_u32(carry);
+                size_t i = 0;
+                for (; i + 4 <= count; i += 4) {
+                    uint32x4_t const x = vld1q_u32(input + i);
+                    uint32x4_t sum = vaddq_u32(x, vextq_u32(zero, x, 3));
+                    sum = vaddq_u32(sum, vextq_u32(zero, sum, 2));
+                    sum = vaddq_u32(sum, c);
+                    vst1q_u32(output + i, inclusive ? sum : vsubq_u32(sum, x));
+                    c = vdupq_laneq_u32(sum, 3);
+                }
+                carry = vgetq_lane_u32(c, 0);
+                return i;
+            }
+
+            inline size_t scan(uint64_t const* input, uint64_t* output, size_t count, uint64_t& carry, bool inclusive) {
+                uint64x2_t const zero = vdupq_n_u64(0);
+                uint64x2_t c = vdupq_n_u64(carry);
+                size_t i = 0;
+                for (; i + 2 <= count; i += 2) {
+                    uint64x2_t const x = vld1q_u64(input + i);
+                    uint64x2_t sum = vaddq_u64(vaddq_u64(x, vextq_u64(zero, x, 1)), c);
+                    vst1q_u64(output + i, inclusive ? sum : vsubq_u64(sum, x));
+                    c = vdupq_laneq_u64(sum, 1);
+                }
+                carry = vgetq_lane_u64(c, 0);
+                return i;
+            }
+        }
+#endif // TUC_SIMD_NEON
+
+        // For 32- and 64-bit integers; the signed ones are processed as unsigned
+        template <typename T>
+        size_t simd_scan([[maybe_unused]] T const* input, [[maybe_unused]] T* output, [[maybe_unused]] size_t count, [[maybe_unused]] T& carry, [[maybe_unused]] bool inclusive) {
+            static_assert(std::is_integral<T>::value && (sizeof(T) == 4 || sizeof(T) == 8), "32- or 64-bit integer type required");
+            using U = std::conditional_t<sizeof(T) == 4, uint32_t, uint64_t>;
+            [[maybe_unused]] U const* const u_input = reinterpret_cast<U const*>(input);
+            [[maybe_unused]] U* const u_output = reinterpret_cast<U*>(output);
+            U u_carry = static_cast<U>(carry);
+            size_t done = 0;
+            switch (simd_detail::selected_instruction_set()) {
+#ifdef TUC_SIMD_X86
+            case simd_detail::instruction_set::avx2: done = avx2::scan(u_input, u_output, count, u_carry, inclusive); break;
+            case simd_detail::instruction_set::sse2: done = sse2::scan(u_input, u_output, count, u_carry, inclusive); break;
+#endif // TUC_SIMD_X86
+#ifdef TUC_SIMD_NEON
+            case simd_detail::instruction_set::neon: done = neon::scan(u_input, u_output, count, u_carry, inclusive); break;
+#endif // TUC_SIMD_NEON
+            default: break;
+            }
+            carry = static_cast<T>(u_carry);
+            return done;
+        }
+
+#if TUC_HAS_EXECUTION_POLICY
+        // Splits the range into chunks that are reduced in parallel; `reduce_chunk(begin, end)` is
+        // expected to return an accumulator, and `combine` to merge two of them. Under
+        // std::execution::par_unseq, neither may block (e.g., on a function-local static).
+        template <typename Accumulator, typename ExecutionPolicy, typename Iterator, typename ReduceChunk, typename Combine>
+        Accumulator parallel_reduce(ExecutionPolicy execution_policy, Iterator begin, Iterator end, Accumulator identity, ReduceChunk reduce_chunk, Combine combine) {
+            using difference_type = typename std::iterator_traits<Iterator>::difference_type;
+            difference_type const count = std::distance(begin, end);
+            difference_type constexpr chunk_size = 1 << 16;
+            std::vector<Iterator> chunk_begins;
+            chunk_begins.reserve(static_cast<size_t>(count / chunk_size + 1));
+            for (difference_type i = 0; i < count; i += chunk_size) {
+                chunk_begins.push_back(std::next(begin, i));
+            }
+            return std::transform_reduce(
+                execution_policy,
+                chunk_begins.begin(),
+                chunk_begins.end(),
+                identity,
+                combine,
+                [&](Iterator chunk_begin) {
+                    auto const chunk_end = std::next(chunk_begin, (std::min)(chunk_size, std::distance(chunk_begin, end)));
+                    return reduce_chunk(chunk_begin, chunk_end);
+                }
+            );
+        }
+#endif // TUC_HAS_EXECUTION_POLICY
+    }
+}
@@ -0,0 +1,114 @@
+#pragma once
+
+// To be included only via other tuc headers
+
+// Explicit SIMD kernels are compiled for the instruction sets below, and the best one supported by
+// the CPU is selected at runtime. Define TUC_DISABLE_SIMD to always use the scalar fallbacks.
+
+#if defined(TUC_DISABLE_SIMD)
+// scalar only
+#elif defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define TUC_SIMD_X86
+#include <immintrin.h>
+#ifdef _MSC_VER
+#include <intrin.h>
+#endif // _MSC_VER
+#elif defined(__aarch64__) || defined(_M_ARM64)
+#define TUC_SIMD_NEON
+#include <arm_neon.h>
+#ifdef _MSC_VER
+#include <intrin.h>
+#endif // _MSC_VER
+#endif
+
+#include <cstdint>
+
+#if defined(TUC_SIMD_X86) && (defined(__GNUC__) || defined(__clang__))
+// Lets AVX2 kernels be compiled without enabling AVX2 for the whole program
+#define TUC_SIMD_TARGET_AVX2 __attribute__((target("avx2")))
+#else
+#define TUC_SIMD_TARGET_AVX2
+#endif
+
+namespace tuc
+{
+    namespace simd_detail
+    {
+        enum struct instruction_set
+        {
+            scalar,
+            sse2,
+            avx2,
+            neon
+        };
+
+        inline bool cpu_supports_avx2()
+        {
+#if !defined(TUC_SIMD_X86)
+            return false;
+#elif defined(_MSC_VER)
+            int registers[4] = {};
+            __cpuid(registers, 1);
+            bool const os_uses_xsave = (registers[2] & (1 << 27)) != 0;
+            if (!os_uses_xsave || (_xgetbv(0) & 6) != 6) { // the OS needs to preserve the YMM registers
+                return false;
+            }
+            __cpuidex(registers, 7, 0);
+            return (registers[1] & (1 << 5)) != 0;
+#else
+            return __builtin_cpu_supports("avx2");
+#endif
+        }
+
+        inline bool is_supported(instruction_set candidate)
+        {
+            switch (candidate) {
+            case instruction_set::scalar: return true;
+#ifdef TUC_SIMD_X86
+            case instruction_set::sse2: return true;
+            case instruction_set::avx2: return cpu_supports_avx2();
+#endif // TUC_SIMD_X86
+#ifdef TUC_SIMD_NEON
+            case instruction_set::neon: return true;
+#endif // TUC_SIMD_NEON
+            default: return false;
+            }
+        }
+
+        inline instruction_set get_best_supported_instruction_set()
+        {
+            for (auto const candidate : { instruction_set::avx2, instruction_set::sse2, instruction_set::neon }) {
+                if (is_supported(candidate)) {
+                    return candidate;
+                }
+            }
+            return instruction_set::scalar;
+        }
+
+        // The index of the lowest set bit of a (non-zero) comparison mask
+        inline int count_trailing_zeros(uint64_t mask)
+        {
+#ifdef _MSC_VER
+            unsigned long index = 0;
+#ifdef _WIN64
+            _BitScanForward64(&index, mask);
+#else
+            if (!_BitScanForward(&index, static_cast<unsigned long>(mask))) {
+                _BitScanForward(&index, static_cast<unsigned long>(mask >> 32));
+                index += 32;
+            }
+#endif // _WIN64
+            return static_cast<int>(index);
+#else
+            return __builtin_ctzll(mask);
+#endif
+        }
+
+        // May be overridden (e.g., in tests) with any instruction set for which is_supported() returns true
+        inline instruction_set& selected_instruction_set()
+        {
+            static instruction_set selected = get_best_supported_instruction_set();
+            return selected;
+        }
+    }
+}
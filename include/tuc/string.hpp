@@ -1,133 +1,756 @@
 #pragma once
 
 #include <string>
-#include <cctype> // std::tolower
+#include <string_view>
 #include <algorithm>
+#include <functional> // std::hash
+#include <iterator>
+#include <type_traits>
+#include <utility> // std::pair
+#include <vector>
+#include "string_detail.hpp"
 
 namespace tuc
 { 
+    enum struct invalid_sequence_policy
+    {
+        replace, // with U+FFFD
+        throw_exception // std::range_error
+    };
+
+    enum struct case_sensitivity
+    {
+        case_sensitive,
+        case_insensitive // folded as by equal_case_insensitive
+    };
+
+    // The functions accept std::basic_string, std::basic_string_view and C strings alike, and do not
+    // allocate. left() and right() return views, except when given a temporary string.
     namespace generic_string
     {
-        template <typename String>
-        String left(String const& input, size_t n)
+        template <typename Char, typename Traits>
+        std::basic_string_view<Char, Traits> left(std::basic_string_view<Char, Traits> input, size_t n)
         {
             return input.substr(0, n);
         }
 
-        template <typename String>
-        String right(String const& input, size_t n)
+        template <typename Char, typename Traits, typename Allocator>
+        std::basic_string_view<Char, Traits> left(std::basic_string<Char, Traits, Allocator> const& input, size_t n)
+        {
+            return left(string_detail::to_view(input), n);
+        }
+
+        template <typename Char>
+        std::basic_string_view<Char> left(Char const* input, size_t n)
+        {
+            return left(string_detail::to_view(input), n);
+        }
+
+        // A view into a temporary would dangle, so return a string instead
+        template <typename Char, typename Traits, typename Allocator>
+        std::basic_string<Char, Traits, Allocator> left(std::basic_string<Char, Traits, Allocator>&& input, size_t n)
+        {
+            input.erase((std::min)(input.length(), n));
+            return std::move(input);
+        }
+
+        template <typename Char, typename Traits>
+        std::basic_string_view<Char, Traits> right(std::basic_string_view<Char, Traits> input, size_t n)
         {
             auto const length = input.length();
             return input.substr(length - (std::min)(length, n));
         }
 
+        template <typename Char, typename Traits, typename Allocator>
+        std::basic_string_view<Char, Traits> right(std::basic_string<Char, Traits, Allocator> const& input, size_t n)
+        {
+            return right(string_detail::to_view(input), n);
+        }
+
+        template <typename Char>
+        std::basic_string_view<Char> right(Char const* input, size_t n)
+        {
+            return right(string_detail::to_view(input), n);
+        }
+
+        template <typename Char, typename Traits, typename Allocator>
+        std::basic_string<Char, Traits, Allocator> right(std::basic_string<Char, Traits, Allocator>&& input, size_t n)
+        {
+            auto const length = input.length();
+            input.erase(0, length - (std::min)(length, n));
+            return std::move(input);
+        }
+
+        template <typename String, typename Candidate>
+        bool starts_with(String const& input, Candidate const& candidate)
+        {
+            auto const input_view = string_detail::to_view(input);
+            auto const candidate_view = string_detail::to_view(candidate);
+            return candidate_view.length() <= input_view.length()
+                && candidate_view == left(input_view, candidate_view.length());
+        }
+
+        template <typename String, typename Candidate>
+        bool ends_with(String const& input, Candidate const& candidate)
+        {
+            auto const input_view = string_detail::to_view(input);
+            auto const candidate_view = string_detail::to_view(candidate);
+            return candidate_view.length() <= input_view.length()
+                && candidate_view == right(input_view, candidate_view.length());
+        }
+
+        // For char, ASCII letters are compared directly (and vectorized), and other characters using
+        // the current locale. Wider characters use Unicode simple case folding.
+        template <typename String1, typename String2>
+        bool equal_case_insensitive(String1 const& lhs, String2 const& rhs)
+        {
+            auto const lhs_view = string_detail::to_view(lhs);
+            auto const rhs_view = string_detail::to_view(rhs);
+            if (lhs_view.size() != rhs_view.size()) {
+                return false;
+            }
+            if constexpr (std::is_same<typename decltype(lhs_view)::value_type, char>::value) {
+                return string_detail::equal_case_insensitive(lhs_view.data(), rhs_view.data(), lhs_view.size());
+            }
+            else {
+                auto const equal = [](auto const& c1, auto const& c2) {
+                    return c1 == c2 || string_detail::fold_case(c1) == string_detail::fold_case(c2);
+                };
+                return std::equal(lhs_view.begin(), lhs_view.end(), rhs_view.begin(), equal);
+            }
+        }
+
+        // For unordered containers with case-insensitive keys, for example:
+        // std::unordered_map<std::string, int, case_insensitive_hash<std::string>, case_insensitive_equal<std::string>>
         template <typename String>
-        bool starts_with(String const& input, String const& candidate)
+        struct case_insensitive_hash
+        {
+            size_t operator()(String const& input) const
+            {
+                using Char = typename String::value_type;
+                size_t constexpr chunk_size = 64;
+                Char folded[chunk_size];
+                size_t hash = input.size();
+                for (size_t i = 0, size = input.size(); i < size; i += chunk_size) {
+                    size_t const n = (std::min)(chunk_size, size - i);
+                    string_detail::fold_case(input.data() + i, folded, n);
+                    size_t const chunk_hash = std::hash<std::basic_string_view<Char>>()(std::basic_string_view<Char>(folded, n));
+                    hash ^= chunk_hash + 0x9e3779b9 + (hash << 6) + (hash >> 2);
+                }
+                return hash;
+            }
+        };
+
+        template <typename String>
+        struct case_insensitive_equal
+        {
+            bool operator()(String const& lhs, String const& rhs) const
+            {
+                return equal_case_insensitive(lhs, rhs);
+            }
+        };
+
+        namespace replace_detail {
+            // Builds the result in a single pass, given the positions of the patterns to be replaced
+            template <typename Char, typename Traits, typename Allocator, typename GetBeforeLength, typename GetAfter>
+            void replace(std::basic_string<Char, Traits, Allocator>& in_out, std::vector<std::pair<size_t, size_t>> const& matches, GetBeforeLength get_before_length, GetAfter get_after)
+            {
+                size_t result_length = in_out.length();
+                for (auto const& match : matches) {
+                    result_length = result_length - get_before_length(match.second) + get_after(match.second).length();
+                }
+                std::basic_string<Char, Traits, Allocator> result(in_out.get_allocator());
+                result.reserve(result_length);
+                size_t copied = 0;
+                for (auto const& match : matches) {
+                    result.append(in_out, copied, match.first - copied);
+                    result.append(get_after(match.second));
+                    copied = match.first + get_before_length(match.second);
+                }
+                result.append(in_out, copied, std::basic_string<Char, Traits, Allocator>::npos);
+                in_out.swap(result);
+            }
+        }
+
+        // Replaces the non-overlapping occurrences, scanning from left to right. If the length changes,
+        // the result is built in a single pass (instead of shifting the tail for each occurrence).
+        template <typename String, typename Before, typename After>
+        size_t replace_all(String& in_out, Before const& before_, After const& after_)
+        {
+            auto const before = string_detail::to_view(before_);
+            auto const after = string_detail::to_view(after_);
+            if (before.empty()) {
+                return 0;
+            }
+            string_detail::searcher<typename String::value_type> const searcher(before);
+            auto const text = string_detail::to_view(in_out);
+            std::vector<std::pair<size_t, size_t>> matches; // (position, pattern index)
+            for (size_t position = searcher.find(text); position != String::npos; position = searcher.find(text, position + before.length())) {
+                matches.emplace_back(position, 0);
+            }
+            if (before.length() == after.length()) {
+                for (auto const& match : matches) {
+                    std::copy(after.begin(), after.end(), in_out.begin() + match.first);
+                }
+            }
+            else if (!matches.empty()) {
+                replace_detail::replace(in_out, matches, [&](size_t) { return before.length(); }, [&](size_t) { return after; });
+            }
+            return matches.size();
+        }
+
+        // Replaces many patterns in a single scan, using the Aho-Corasick algorithm. At each position,
+        // the longest matching pattern is replaced, and the scan continues after it (so replacements are
+        // never replaced again). Construct once, and reuse for each input.
+        template <typename Char>
+        class replacer
+        {
+        public:
+            using string_type = std::basic_string<Char>;
+            using view_type = std::basic_string_view<Char>;
+
+            replacer(std::vector<std::pair<view_type, view_type>> const& replacements)
+                : automaton(get_befores(replacements))
+            {
+                afters.reserve(replacements.size());
+                for (auto const& replacement : replacements) {
+                    afters.emplace_back(replacement.second);
+                }
+            }
+
+            // Returns the number of replacements made
+            template <typename Traits, typename Allocator>
+            size_t replace_all(std::basic_string<Char, Traits, Allocator>& in_out) const
+            {
+                std::vector<std::pair<size_t, size_t>> matches;
+                automaton.find_all(string_detail::to_view(in_out), [&matches](size_t position, size_t pattern_index) {
+                    matches.emplace_back(position, pattern_index);
+                });
+                if (!matches.empty()) {
+                    replace_detail::replace(
+                        in_out, matches,
+                        [this](size_t pattern_index) { return automaton.get_pattern_length(pattern_index); },
+                        [this](size_t pattern_index) { return view_type(afters[pattern_index]); }
+                    );
+                }
+                return matches.size();
+            }
+
+        private:
+            static std::vector<view_type> get_befores(std::vector<std::pair<view_type, view_type>> const& replacements)
+            {
+                std::vector<view_type> befores;
+                befores.reserve(replacements.size());
+                for (auto const& replacement : replacements) {
+                    befores.push_back(replacement.first);
+                }
+                return befores;
+            }
+
+            string_detail::aho_corasick<Char> const automaton;
+            std::vector<string_type> afters;
+        };
+
+        // A convenience wrapper for the above, e.g.: replace_all(text, { { "{name}", name }, { "{date}", date } })
+        template <typename Char, typename Traits, typename Allocator>
+        size_t replace_all(std::basic_string<Char, Traits, Allocator>& in_out, std::vector<std::pair<std::basic_string_view<Char>, std::basic_string_view<Char>>> const& replacements)
+        {
+            return replacer<Char>(replacements).replace_all(in_out);
+        }
+
+        // A precompiled substring searcher, e.g., searcher<char>(needle).find(haystack). Construct once,
+        // and reuse for each haystack.
+        template <typename Char>
+        using searcher = string_detail::searcher<Char>;
+
+        // Searches for many needles in a single pass, using the Aho-Corasick algorithm. Construct once,
+        // and reuse for each haystack.
+        template <typename Char>
+        class multi_searcher
+        {
+        public:
+            using view_type = std::basic_string_view<Char>;
+
+            // Empty needles are never found
+            multi_searcher(std::vector<view_type> const& needles)
+                : automaton(needles)
+            {}
+
+            // Returns the position of the first occurrence of any of the needles, and the index of that
+            // needle (the longest one, if several start there); or (npos, npos) if none is found
+            std::pair<size_t, size_t> find_first(view_type haystack, size_t from = 0) const
+            {
+                return automaton.find_first(haystack, from);
+            }
+
+            bool contains_any(view_type haystack) const
+            {
+                return find_first(haystack).first != view_type::npos;
+            }
+
+        private:
+            string_detail::aho_corasick<Char> const automaton;
+        };
+
+        template <typename String, typename Char>
+        std::pair<size_t, size_t> find_first_of_many(String const& haystack, std::vector<std::basic_string_view<Char>> const& needles)
+        {
+            return multi_searcher<Char>(needles).find_first(string_detail::to_view(haystack));
+        }
+
+        template <typename String, typename Char>
+        bool contains_any(String const& haystack, std::vector<std::basic_string_view<Char>> const& needles)
+        {
+            return multi_searcher<Char>(needles).contains_any(string_detail::to_view(haystack));
+        }
+
+        // Matches inputs against many candidate prefixes (or suffixes) at once, using a trie, in time
+        // that depends on the length of the input, not on the number of candidates. Construct once,
+        // and reuse for each input.
+        template <typename Char, bool Suffixes>
+        class affix_matcher
+        {
+        public:
+            using view_type = std::basic_string_view<Char>;
+            static size_t constexpr npos = view_type::npos;
+
+            // If there are duplicate candidates, only the first one is ever returned
+            affix_matcher(std::vector<view_type> const& candidates, case_sensitivity sensitivity = case_sensitivity::case_sensitive)
+                : automaton(candidates, Suffixes, sensitivity == case_sensitivity::case_insensitive)
+            {}
+
+            // Returns the index of the longest matching candidate, or npos
+            size_t find_longest(view_type input) const
+            {
+                size_t longest = npos;
+                automaton.find(input, [&longest](size_t candidate_index) {
+                    longest = candidate_index;
+                    return true;
+                });
+                return longest;
+            }
+
+            // Returns the indices of all the matching candidates, from the shortest
+            std::vector<size_t> find_all(view_type input) const
+            {
+                std::vector<size_t> candidate_indices;
+                automaton.find(input, [&candidate_indices](size_t candidate_index) {
+                    candidate_indices.push_back(candidate_index);
+                    return true;
+                });
+                return candidate_indices;
+            }
+
+            bool matches_any(view_type input) const
+            {
+                bool found = false;
+                automaton.find(input, [&found](size_t) {
+                    found = true;
+                    return false;
+                });
+                return found;
+            }
+
+        private:
+            string_detail::trie<Char> const automaton;
+        };
+
+        template <typename Char>
+        using prefix_matcher = affix_matcher<Char, false>;
+
+        template <typename Char>
+        using suffix_matcher = affix_matcher<Char, true>;
+
+        // Converts UTF-8 to UTF-16 or UTF-32, depending on the size of Char (e.g., of wchar_t).
+        // Vectorized for runs of ASCII.
+        template <typename Char, typename String>
+        std::basic_string<Char> from_utf8(String const& input, invalid_sequence_policy policy = invalid_sequence_policy::throw_exception)
         {
-            auto const candidate_length = candidate.length();
-            return candidate_length <= input.length()
-                && candidate == left(input, candidate_length);
+            return unicode_detail::transcode<Char>(string_detail::to_view(input), policy == invalid_sequence_policy::replace);
         }
 
+        // Converts UTF-16 or UTF-32 (depending on the size of the characters) to UTF-8
         template <typename String>
-        bool ends_with(String const& input, String const& candidate)
+        std::string to_utf8(String const& input, invalid_sequence_policy policy = invalid_sequence_policy::throw_exception)
         {
-            auto const candidate_length = candidate.length();
-            return candidate_length <= input.length()
-                && candidate == right(input, candidate_length);
+            return unicode_detail::transcode<char>(string_detail::to_view(input), policy == invalid_sequence_policy::replace);
         }
 
         template <typename String>
-        bool equal_case_insensitive(String const& lhs, String const& rhs)
+        bool is_valid_utf8(String const& input)
         {
-            if (lhs.size() != rhs.size()) {
-                return false;
-            }
-            auto const equal = [](auto const& c1, auto const& c2) {
-                return c1 == c2 || std::tolower(c1) == std::tolower(c2);
+            return unicode_detail::is_valid_utf8(string_detail::to_view(input));
+        }
+
+        // A lazy range of the tokens between delimiters, as views into the input (which therefore needs
+        // to outlive the range). Created by the split functions below.
+        template <typename Char, typename Finder>
+        class split_range
+        {
+        public:
+            using view_type = std::basic_string_view<Char>;
+
+            split_range(view_type input, Finder finder, bool skip_empty_tokens)
+                : input(input)
+                , finder(std::move(finder))
+                , skip_empty_tokens(skip_empty_tokens)
+            {}
+
+            class iterator
+            {
+            public:
+                using iterator_category = std::forward_iterator_tag;
+                using value_type = view_type;
+                using difference_type = std::ptrdiff_t;
+                using pointer = value_type const*;
+                using reference = value_type const&;
+
+                iterator() = default;
+
+                reference operator*() const { return token; }
+                pointer operator->() const { return &token; }
+
+                iterator& operator++() {
+                    do {
+                        if (token_end == range->input.length()) {
+                            range = nullptr; // the end
+                            return *this;
+                        }
+                        find_token(token_end + range->finder.get_length());
+                    } while (range->skip_empty_tokens && token.empty());
+                    return *this;
+                }
+
+                iterator operator++(int) {
+                    iterator result = *this;
+                    ++*this;
+                    return result;
+                }
+
+                bool operator==(iterator const& that) const {
+                    return range == that.range && (range == nullptr || token.data() == that.token.data());
+                }
+
+                bool operator!=(iterator const& that) const { return !(*this == that); }
+
+            private:
+                friend class split_range;
+
+                explicit iterator(split_range const* range)
+                    : range(range)
+                {
+                    find_token(0);
+                    if (range->skip_empty_tokens && token.empty()) {
+                        ++*this;
+                    }
+                }
+
+                void find_token(size_t token_begin) {
+                    size_t const delimiter = range->finder.find(range->input, token_begin);
+                    token_end = delimiter == view_type::npos ? range->input.length() : delimiter;
+                    token = range->input.substr(token_begin, token_end - token_begin);
+                }
+
+                split_range const* range = nullptr;
+                view_type token;
+                size_t token_end = 0;
             };
-            return std::equal(lhs.begin(), lhs.end(), rhs.begin(), equal);
+
+            iterator begin() const { return iterator(this); }
+            iterator end() const { return iterator(); }
+
+        private:
+            view_type const input;
+            Finder const finder;
+            bool const skip_empty_tokens;
+        };
+
+        // Splits at each delimiter, which may be a single character or a string: n delimiters give
+        // n + 1 tokens, some of which may be empty
+        template <typename String, typename Delimiter>
+        auto split(String const& input, Delimiter const& delimiter)
+        {
+            auto const input_view = string_detail::to_view(input);
+            using Char = typename decltype(input_view)::value_type;
+            if constexpr (std::is_same<Delimiter, Char>::value) {
+                using finder = string_detail::character_finder<Char>;
+                return split_range<Char, finder>(input_view, finder(delimiter), false);
+            }
+            else {
+                using finder = string_detail::substring_finder<Char>;
+                return split_range<Char, finder>(input_view, finder(string_detail::to_view(delimiter)), false);
+            }
         }
 
-        // adapted from here: https://stackoverflow.com/questions/3418231/replace-part-of-a-string-with-another-string
-        template <typename String>
-        size_t replace_all(String& in_out, String const& before, String const& after)
+        // Splits at any of the delimiter characters (vectorized for char, if there are at most 16 of them)
+        template <typename String, typename Delimiters>
+        auto split_any_of(String const& input, Delimiters const& delimiters)
         {
-            size_t start_pos = 0, counter = 0;
-            while ((start_pos = in_out.find(before, start_pos)) != std::string::npos) {
-                in_out.replace(start_pos, before.length(), after);
-                start_pos += after.length();
-                ++counter;
+            auto const input_view = string_detail::to_view(input);
+            using Char = typename decltype(input_view)::value_type;
+            using finder = string_detail::character_set_finder<Char>;
+            return split_range<Char, finder>(input_view, finder(string_detail::to_view(delimiters)), false);
+        }
+
+        // Like split_any_of, but skips the empty tokens
+        template <typename String, typename Delimiters>
+        auto tokenize(String const& input, Delimiters const& delimiters)
+        {
+            auto const input_view = string_detail::to_view(input);
+            using Char = typename decltype(input_view)::value_type;
+            using finder = string_detail::character_set_finder<Char>;
+            return split_range<Char, finder>(input_view, finder(string_detail::to_view(delimiters)), true);
+        }
+
+        // Joins strings or views (any forward range of them), allocating the result only once
+        template <typename Parts, typename Separator>
+        auto join(Parts const& parts, Separator const& separator_)
+        {
+            auto const separator = string_detail::to_view(separator_);
+            using Char = typename decltype(separator)::value_type;
+            size_t length = 0;
+            size_t count = 0;
+            for (auto const& part : parts) {
+                length += string_detail::to_view(part).length();
+                ++count;
+            }
+            std::basic_string<Char> result;
+            if (count == 0) {
+                return result;
+            }
+            result.reserve(length + (count - 1) * separator.length());
+            bool first = true;
+            for (auto const& part : parts) {
+                if (!first) {
+                    result.append(separator);
+                }
+                result.append(string_detail::to_view(part));
+                first = false;
             }
-            return counter;
+            return result;
         }
     }
 
     // Convenience wrappers for std::string
     namespace string
     {
-        inline std::string left(std::string const& input, size_t n)
+        inline std::string_view left(std::string_view input, size_t n)
         {
             return generic_string::left(input, n);
         }
 
-        inline std::string right(std::string const& input, size_t n)
+        inline std::string_view left(char const* input, size_t n)
+        {
+            return generic_string::left(input, n);
+        }
+
+        inline std::string left(std::string&& input, size_t n)
+        {
+            return generic_string::left(std::move(input), n);
+        }
+
+        inline std::string_view right(std::string_view input, size_t n)
+        {
+            return generic_string::right(input, n);
+        }
+
+        inline std::string_view right(char const* input, size_t n)
         {
             return generic_string::right(input, n);
         }
 
-        inline bool starts_with(std::string const& input, std::string const& candidate)
+        inline std::string right(std::string&& input, size_t n)
+        {
+            return generic_string::right(std::move(input), n);
+        }
+
+        inline bool starts_with(std::string_view input, std::string_view candidate)
         {
             return generic_string::starts_with(input, candidate);
         }
 
-        inline bool ends_with(std::string const& input, std::string const& candidate)
+        inline bool ends_with(std::string_view input, std::string_view candidate)
         {
             return generic_string::ends_with(input, candidate);
         }
 
-        inline bool equal_case_insensitive(std::string const& lhs, std::string const& rhs)
+        inline bool equal_case_insensitive(std::string_view lhs, std::string_view rhs)
         {
             return generic_string::equal_case_insensitive(lhs, rhs);
         }
 
-        inline size_t replace_all(std::string& in_out, std::string const& before, std::string const& after)
+        using case_insensitive_hash = generic_string::case_insensitive_hash<std::string>;
+        using case_insensitive_equal = generic_string::case_insensitive_equal<std::string>;
+
+        inline size_t replace_all(std::string& in_out, std::string_view before, std::string_view after)
         {
             return generic_string::replace_all(in_out, before, after);
         }
+
+        using replacer = generic_string::replacer<char>;
+        using searcher = generic_string::searcher<char>;
+        using multi_searcher = generic_string::multi_searcher<char>;
+        using prefix_matcher = generic_string::prefix_matcher<char>;
+        using suffix_matcher = generic_string::suffix_matcher<char>;
+
+        inline std::wstring to_wstring(std::string_view utf8, invalid_sequence_policy policy = invalid_sequence_policy::throw_exception)
+        {
+            return generic_string::from_utf8<wchar_t>(utf8, policy);
+        }
+
+        inline bool is_valid_utf8(std::string_view input)
+        {
+            return generic_string::is_valid_utf8(input);
+        }
+
+        inline std::pair<size_t, size_t> find_first_of_many(std::string_view haystack, std::vector<std::string_view> const& needles)
+        {
+            return generic_string::find_first_of_many(haystack, needles);
+        }
+
+        inline bool contains_any(std::string_view haystack, std::vector<std::string_view> const& needles)
+        {
+            return generic_string::contains_any(haystack, needles);
+        }
+
+        inline size_t replace_all(std::string& in_out, std::vector<std::pair<std::string_view, std::string_view>> const& replacements)
+        {
+            return generic_string::replace_all(in_out, replacements);
+        }
+
+        inline auto split(std::string_view input, char delimiter)
+        {
+            return generic_string::split(input, delimiter);
+        }
+
+        inline auto split(std::string_view input, std::string_view delimiter)
+        {
+            return generic_string::split(input, delimiter);
+        }
+
+        inline auto split_any_of(std::string_view input, std::string_view delimiters)
+        {
+            return generic_string::split_any_of(input, delimiters);
+        }
+
+        inline auto tokenize(std::string_view input, std::string_view delimiters = " \t\n\r\f\v")
+        {
+            return generic_string::tokenize(input, delimiters);
+        }
+
+        template <typename Parts>
+        std::string join(Parts const& parts, std::string_view separator)
+        {
+            return generic_string::join(parts, separator);
+        }
     }
 
     // Convenience wrappers for std::wstring
     namespace wstring
     {
-        inline std::wstring left(std::wstring const& input, size_t n)
+        inline std::wstring_view left(std::wstring_view input, size_t n)
+        {
+            return generic_string::left(input, n);
+        }
+
+        inline std::wstring_view left(wchar_t const* input, size_t n)
         {
             return generic_string::left(input, n);
         }
 
-        inline std::wstring right(std::wstring const& input, size_t n)
+        inline std::wstring left(std::wstring&& input, size_t n)
+        {
+            return generic_string::left(std::move(input), n);
+        }
+
+        inline std::wstring_view right(std::wstring_view input, size_t n)
+        {
+            return generic_string::right(input, n);
+        }
+
+        inline std::wstring_view right(wchar_t const* input, size_t n)
         {
             return generic_string::right(input, n);
         }
 
-        inline bool starts_with(std::wstring const& input, std::wstring const& candidate)
+        inline std::wstring right(std::wstring&& input, size_t n)
+        {
+            return generic_string::right(std::move(input), n);
+        }
+
+        inline bool starts_with(std::wstring_view input, std::wstring_view candidate)
         {
             return generic_string::starts_with(input, candidate);
         }
 
-        inline bool ends_with(std::wstring const& input, std::wstring const& candidate)
+        inline bool ends_with(std::wstring_view input, std::wstring_view candidate)
         {
             return generic_string::ends_with(input, candidate);
         }
 
-        inline bool equal_case_insensitive(std::wstring const& lhs, std::wstring const& rhs)
+        inline bool equal_case_insensitive(std::wstring_view lhs, std::wstring_view rhs)
         {
             return generic_string::equal_case_insensitive(lhs, rhs);
         }
 
-        inline size_t replace_all(std::wstring& in_out, std::wstring const& before, std::wstring const& after)
+        using case_insensitive_hash = generic_string::case_insensitive_hash<std::wstring>;
+        using case_insensitive_equal = generic_string::case_insensitive_equal<std::wstring>;
+
+        inline size_t replace_all(std::wstring& in_out, std::wstring_view before, std::wstring_view after)
         {
             return generic_string::replace_all(in_out, before, after);
         }
+
+        using replacer = generic_string::replacer<wchar_t>;
+        using searcher = generic_string::searcher<wchar_t>;
+        using multi_searcher = generic_string::multi_searcher<wchar_t>;
+        using prefix_matcher = generic_string::prefix_matcher<wchar_t>;
+        using suffix_matcher = generic_string::suffix_matcher<wchar_t>;
+
+        inline std::string to_string(std::wstring_view input, invalid_sequence_policy policy = invalid_sequence_policy::throw_exception)
+        {
+            return generic_string::to_utf8(input, policy);
+        }
+
+        inline std::pair<size_t, size_t> find_first_of_many(std::wstring_view haystack, std::vector<std::wstring_view> const& needles)
+        {
+            return generic_string::find_first_of_many(haystack, needles);
+        }
+
+        inline bool contains_any(std::wstring_view haystack, std::vector<std::wstring_view> const& needles)
+        {
+            return generic_string::contains_any(haystack, needles);
+        }
+
+        inline size_t replace_all(std::wstring& in_out, std::vector<std::pair<std::wstring_view, std::wstring_view>> const& replacements)
+        {
+            return generic_string::replace_all(in_out, replacements);
+        }
+
+        inline auto split(std::wstring_view input, wchar_t delimiter)
+        {
+            return generic_string::split(input, delimiter);
+        }
+
+        inline auto split(std::wstring_view input, std::wstring_view delimiter)
+        {
+            return generic_string::split(input, delimiter);
+        }
+
+        inline auto split_any_of(std::wstring_view input, std::wstring_view delimiters)
+        {
+            return generic_string::split_any_of(input, delimiters);
+        }
+
+        inline auto tokenize(std::wstring_view input, std::wstring_view delimiters = L" \t\n\r\f\v")
+        {
+            return generic_string::tokenize(input, delimiters);
+        }
+
+        template <typename Parts>
+        std::wstring join(Parts const& parts, std::wstring_view separator)
+        {
+            return generic_string::join(parts, separator);
+        }
     }
 }
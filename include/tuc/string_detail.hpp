@@ -0,0 +1,808 @@
+#pragma once
+
+// To be included only via tuc/string.hpp
+
+#include "simd_detail.hpp"
+#include "unicode_detail.hpp"
+#include <algorithm> // std::min
+#include <cctype> // std::tolower
+#include <cstddef>
+#include <cstring> // std::memcmp
+#include <string>
+#include <string_view>
+#include <type_traits>
+#include <unordered_map>
+#include <utility> // std::pair
+#include <vector>
+
+namespace tuc
+{
+    namespace string_detail
+    {
+        // Lets the functions accept strings, views and C strings alike
+        template <typename Char, typename Traits>
+        std::basic_string_view<Char, Traits> to_view(std::basic_string_view<Char, Traits> input) {
+            return input;
+        }
+
+        template <typename Char, typename Traits, typename Allocator>
+        std::basic_string_view<Char, Traits> to_view(std::basic_string<Char, Traits, Allocator> const& input) {
+            return input;
+        }
+
+        template <typename Char>
+        std::basic_string_view<Char> to_view(Char const* input) {
+            return input;
+        }
+
+        // ASCII letters are folded directly; other characters using the current locale
+        inline char fold_case(char c) {
+            unsigned char const u = static_cast<unsigned char>(c); // std::tolower is undefined for negative values
+            if (u < 0x80) {
+                return u >= 'A' && u <= 'Z' ? static_cast<char>(u | 0x20) : c;
+            }
+            return static_cast<char>(std::tolower(u));
+        }
+
+        // Wider characters using Unicode simple case folding (for UTF-16, that of the BMP)
+        template <typename Char>
+        Char fold_case(Char c) {
+            return static_cast<Char>(unicode_detail::fold_case(static_cast<char32_t>(static_cast<std::make_unsigned_t<Char>>(c))));
+        }
+
+        // The SIMD kernels: fold the ASCII letters of full vectors, and return the number of bytes processed.
+        // Vectors with non-ASCII bytes are left to the scalar code.
+
+#ifdef TUC_SIMD_X86
+        namespace sse2
+        {
+            inline __m128i fold_ascii_case(__m128i x) {
+                // Bytes above 0x7f are negative here, so they are never considered upper case
+                __m128i const is_upper = _mm_and_si128(_mm_cmpgt_epi8(x, _mm_set1_epi8('A' - 1)), _mm_cmplt_epi8(x, _mm_set1_epi8('Z' + 1)));
+                return _mm_or_si128(x, _mm_and_si128(is_upper, _mm_set1_epi8(0x20)));
+            }
+
+            // The number of leading bytes that are equal after folding
+            inline size_t equal_case_insensitive_prefix(char const* lhs, char const* rhs, size_t count) {
+                size_t i = 0;
+                for (; i + 16 <= count; i += 16) {
+                    __m128i const a = _mm_loadu_si128(reinterpret_cast<__m128i const*>(lhs + i));
+                    __m128i const b = _mm_loadu_si128(reinterpret_cast<__m128i const*>(rhs + i));
+                    if (_mm_movemask_epi8(_mm_cmpeq_epi8(fold_ascii_case(a), fold_ascii_case(b))) != 0xffff) {
+                        break;
+                    }
+                }
+                return i;
+            }
+
+            inline size_t fold_case(char const* input, char* output, size_t count) {
+                size_t i = 0;
+                for (; i + 16 <= count; i += 16) {
+                    __m128i const x = _mm_loadu_si128(reinterpret_cast<__m128i const*>(input + i));
+                    if (_mm_movemask_epi8(x) != 0) {
+                        break;
+                    }
+                    _mm_storeu_si128(reinterpret_cast<__m128i*>(output + i), fold_ascii_case(x));
+                }
+                return i;
+            }
+        }
+
+        namespace avx2
+        {
+            TUC_SIMD_TARGET_AVX2 inline __m256i fold_ascii_case(__m256i x) {
+                __m256i const is_upper = _mm256_andnot_si256(_mm256_cmpgt_epi8(x, _mm256_set1_epi8('Z')), _mm256_cmpgt_epi8(x, _mm256_set1_epi8('A' - 1)));
+                return _mm256_or_si256(x, _mm256_and_si256(is_upper, _mm256_set1_epi8(0x20)));
+            }
+
+            TUC_SIMD_TARGET_AVX2 inline size_t equal_case_insensitive_prefix(char const* lhs, char const* rhs, size_t count) {
+                size_t i = 0;
+                for (; i + 32 <= count; i += 32) {
+                    __m256i const a = _mm256_loadu_si256(reinterpret_cast<__m256i const*>(lhs + i));
+                    __m256i const b = _mm256_loadu_si256(reinterpret_cast<__m256i const*>(rhs + i));
+                    if (_mm256_movemask_epi8(_mm256_cmpeq_epi8(fold_ascii_case(a), fold_ascii_case(b))) != -1) {
+                        break;
+                    }
+                }
+                return i;
+            }
+
+            TUC_SIMD_TARGET_AVX2 inline size_t fold_case(char const* input, char* output, size_t count) {
+                size_t i = 0;
+                for (; i + 32 <= count; i += 32) {
+                    __m256i const x = _mm256_loadu_si256(reinterpret_cast<__m256i const*>(input + i));
+                    if (_mm256_movemask_epi8(x) != 0) {
+                        break;
+                    }
+                    _mm256_storeu_si256(reinterpret_cast<__m256i*>(output + i), fold_ascii_case(x));
+                }
+                return i;
+            }
+        }
+#endif // TUC_SIMD_X86
+
+#ifdef TUC_SIMD_NEON
+        namespace neon
+        {
+            inline uint8x16_t fold_ascii_case(uint8x16_t x) {
+                uint8x16_t const is_upper = vandq_u8(vcgeq_u8(x, vdupq_n_u8('A')), vcleq_u8(x, vdupq_n_u8('Z')));
+                return vorrq_u8(x, vandq_u8(is_upper, vdupq_n_u8(0x20)));
+            }
+
+            inline size_t equal_case_insensitive_prefix(char const* lhs, char const* rhs, size_t count) {
+                size_t i = 0;
+                for (; i + 16 <= count; i += 16) {
+                    uint8x16_t const a = vld1q_u8(reinterpret_cast<uint8_t const*>(lhs + i));
+                    uint8x16_t const b = vld1q_u8(reinterpret_cast<uint8_t const*>(rhs + i));
+                    if (vminvq_u8(vceqq_u8(fold_ascii_case(a), fold_ascii_case(b))) != 0xff) {
+                        break;
+                    }
+                }
+                return i;
+            }
+
+            inline size_t fold_case(char const* input, char* output, size_t count) {
+                size_t i = 0;
+                for (; i + 16 <= count; i += 16) {
+                    uint8x16_t const x = vld1q_u8(reinterpret_cast<uint8_t const*>(input + i));
+                    if (vmaxvq_u8(x) >= 0x80) {
+                        break;
+                    }
+                    vst1q_u8(reinterpret_cast<uint8_t*>(output + i), fold_ascii_case(x));
+                }
+                return i;
+            }
+        }
+#endif // TUC_SIMD_NEON
+
+        // The SIMD kernels stop at the first vector they can't handle; that vector (or the remaining tail)
+        // is then processed using the scalar code, after which the kernels are given another go
+        size_t constexpr max_vector_size = 32;
+
+        inline size_t equal_case_insensitive_prefix([[maybe_unused]] char const* lhs, [[maybe_unused]] char const* rhs, [[maybe_unused]] size_t count) {
+            switch (simd_detail::selected_instruction_set()) {
+#ifdef TUC_SIMD_X86
+            case simd_detail::instruction_set::avx2: return avx2::equal_case_insensitive_prefix(lhs, rhs, count);
+            case simd_detail::instruction_set::sse2: return sse2::equal_case_insensitive_prefix(lhs, rhs, count);
+#endif // TUC_SIMD_X86
+#ifdef TUC_SIMD_NEON
+            case simd_detail::instruction_set::neon: return neon::equal_case_insensitive_prefix(lhs, rhs, count);
+#endif // TUC_SIMD_NEON
+            default: return 0;
+            }
+        }
+
+        inline bool equal_case_insensitive(char const* lhs, char const* rhs, size_t count) {
+            size_t i = 0;
+            while (i < count) {
+                i += equal_case_insensitive_prefix(lhs + i, rhs + i, count - i);
+                for (size_t const end = (std::min)(count, i + max_vector_size); i < end; ++i) {
+                    if (lhs[i] != rhs[i] && fold_case(lhs[i]) != fold_case(rhs[i])) {
+                        return false;
+                    }
+                }
+            }
+            return true;
+        }
+
+        inline void fold_case([[maybe_unused]] char const* input, [[maybe_unused]] char* output, size_t count) {
+            size_t i = 0;
+            while (i < count) {
+                switch (simd_detail::selected_instruction_set()) {
+#ifdef TUC_SIMD_X86
+                case simd_detail::instruction_set::avx2: i += avx2::fold_case(input + i, output + i, count - i); break;
+                case simd_detail::instruction_set::sse2: i += sse2::fold_case(input + i, output + i, count - i); break;
+#endif // TUC_SIMD_X86
+#ifdef TUC_SIMD_NEON
+                case simd_detail::instruction_set::neon: i += neon::fold_case(input + i, output + i, count - i); break;
+#endif // TUC_SIMD_NEON
+                default: break;
+                }
+                for (size_t const end = (std::min)(count, i + max_vector_size); i < end; ++i) {
+                    output[i] = fold_case(input[i]);
+                }
+            }
+        }
+
+        template <typename Char>
+        void fold_case(Char const* input, Char* output, size_t count) {
+            for (size_t i = 0; i < count; ++i) {
+                output[i] = fold_case(input[i]);
+            }
+        }
+
+        // Finding the first of a set of delimiter characters: the SIMD kernels compare each vector to
+        // each delimiter (up to max_simd_delimiter_count of them), and return the number of bytes
+        // skipped that contain none of the delimiters.
+        size_t constexpr max_simd_delimiter_count = 16;
+
+#ifdef TUC_SIMD_X86
+        namespace sse2
+        {
+            inline size_t skip_none_of(char const* input, size_t count, char const* delimiters, size_t delimiter_count) {
+                __m128i needles[max_simd_delimiter_count];
+                for (size_t j = 0; j < delimiter_count; ++j) {
+                    needles[j] = _mm_set1_epi8(delimiters[j]);
+                }
+                size_t i = 0;
+                for (; i + 16 <= count; i += 16) {
+                    __m128i const x = _mm_loadu_si128(reinterpret_cast<__m128i const*>(input + i));
+                    __m128i found = _mm_setzero_si128();
+                    for (size_t j = 0; j < delimiter_count; ++j) {
+                        found = _mm_or_si128(found, _mm_cmpeq_epi8(x, needles[j]));
+                    }
+                    if (_mm_movemask_epi8(found) != 0) {
+                        break;
+                    }
+                }
+                return i;
+            }
+        }
+
+        namespace avx2
+        {
+            TUC_SIMD_TARGET_AVX2 inline size_t skip_none_of(char const* input, size_t count, char const* delimiters, size_t delimiter_count) {
+                __m256i needles[max_simd_delimiter_count];
+                for (size_t j = 0; j < delimiter_count; ++j) {
+                    needles[j] = _mm256_set1_epi8(delimiters[j]);
+                }
+                size_t i = 0;
+                for (; i + 32 <= count; i += 32) {
+                    __m256i const x = _mm256_loadu_si256(reinterpret_cast<__m256i const*>(input + i));
+                    __m256i found = _mm256_setzero_si256();
+                    for (size_t j = 0; j < delimiter_count; ++j) {
+                        found = _mm256_or_si256(found, _mm256_cmpeq_epi8(x, needles[j]));
+                    }
+                    if (_mm256_movemask_epi8(found) != 0) {
+                        break;
+                    }
+                }
+                return i;
+            }
+        }
+#endif // TUC_SIMD_X86
+
+#ifdef TUC_SIMD_NEON
+        namespace neon
+        {
+            inline size_t skip_none_of(char const* input, size_t count, char const* delimiters, size_t delimiter_count) {
+                uint8x16_t needles[max_simd_delimiter_count];
+                for (size_t j = 0; j < delimiter_count; ++j) {
+                    needles[j] = vdupq_n_u8(static_cast<uint8_t>(delimiters[j]));
+                }
+                size_t i = 0;
+                for (; i + 16 <= count; i += 16) {
+                    uint8x16_t const x = vld1q_u8(reinterpret_cast<uint8_t const*>(input + i));
+                    uint8x16_t found = vdupq_n_u8(0);
+                    for (size_t j = 0; j < delimiter_count; ++j) {
+                        found = vorrq_u8(found, vceqq_u8(x, needles[j]));
+                    }
+                    if (vmaxvq_u8(found) != 0) {
+                        break;
+                    }
+                }
+                return i;
+            }
+        }
+#endif // TUC_SIMD_NEON
+
+        inline size_t skip_none_of([[maybe_unused]] char const* input, [[maybe_unused]] size_t count, [[maybe_unused]] char const* delimiters, [[maybe_unused]] size_t delimiter_count) {
+            if (delimiter_count > max_simd_delimiter_count) {
+                return 0;
+            }
+            switch (simd_detail::selected_instruction_set()) {
+#ifdef TUC_SIMD_X86
+            case simd_detail::instruction_set::avx2: return avx2::skip_none_of(input, count, delimiters, delimiter_count);
+            case simd_detail::instruction_set::sse2: return sse2::skip_none_of(input, count, delimiters, delimiter_count);
+#endif // TUC_SIMD_X86
+#ifdef TUC_SIMD_NEON
+            case simd_detail::instruction_set::neon: return neon::skip_none_of(input, count, delimiters, delimiter_count);
+#endif // TUC_SIMD_NEON
+            default: return 0;
+            }
+        }
+
+        // Substring search (Mula, "SIMD-friendly algorithms for substring searching"): the candidate
+        // positions are those where both the first and the last character of the needle match, which
+        // rarely happens by chance, and only these are compared in full. The kernels check position_count
+        // candidate positions (reading up to position_count + needle_length - 1 bytes) in whole vectors,
+        // and return the first match (setting found), or else the number of positions checked.
+#ifdef TUC_SIMD_X86
+        namespace sse2
+        {
+            inline size_t find_substring(char const* haystack, size_t position_count, char const* needle, size_t needle_length, bool& found) {
+                __m128i const first = _mm_set1_epi8(needle[0]);
+                __m128i const last = _mm_set1_epi8(needle[needle_length - 1]);
+                size_t i = 0;
+                for (; i + 16 <= position_count; i += 16) {
+                    __m128i const block_first = _mm_loadu_si128(reinterpret_cast<__m128i const*>(haystack + i));
+                    __m128i const block_last = _mm_loadu_si128(reinterpret_cast<__m128i const*>(haystack + i + needle_length - 1));
+                    uint32_t mask = static_cast<uint32_t>(_mm_movemask_epi8(_mm_and_si128(_mm_cmpeq_epi8(block_first, first), _mm_cmpeq_epi8(block_last, last))));
+                    for (; mask != 0; mask &= mask - 1) {
+                        size_t const position = i + simd_detail::count_trailing_zeros(mask);
+                        if (std::memcmp(haystack + position + 1, needle + 1, needle_length - 2) == 0) {
+                            found = true;
+                            return position;
+                        }
+                    }
+                }
+                return i;
+            }
+        }
+
+        namespace avx2
+        {
+            TUC_SIMD_TARGET_AVX2 inline size_t find_substring(char const* haystack, size_t position_count, char const* needle, size_t needle_length, bool& found) {
+                __m256i const first = _mm256_set1_epi8(needle[0]);
+                __m256i const last = _mm256_set1_epi8(needle[needle_length - 1]);
+                size_t i = 0;
+                for (; i + 32 <= position_count; i += 32) {
+                    __m256i const block_first = _mm256_loadu_si256(reinterpret_cast<__m256i const*>(haystack + i));
+                    __m256i const block_last = _mm256_loadu_si256(reinterpret_cast<__m256i const*>(haystack + i + needle_length - 1));
+                    uint32_t mask = static_cast<uint32_t>(_mm256_movemask_epi8(_mm256_and_si256(_mm256_cmpeq_epi8(block_first, first), _mm256_cmpeq_epi8(block_last, last))));
+                    for (; mask != 0; mask &= mask - 1) {
+                        size_t const position = i + simd_detail::count_trailing_zeros(mask);
+                        if (std::memcmp(haystack + position + 1, needle + 1, needle_length - 2) == 0) {
+                            found = true;
+                            return position;
+                        }
+                    }
+                }
+                return i;
+            }
+        }
+#endif // TUC_SIMD_X86
+
+#ifdef TUC_SIMD_NEON
+        namespace neon
+        {
+            inline size_t find_substring(char const* haystack, size_t position_count, char const* needle, size_t needle_length, bool& found) {
+                uint8x16_t const first = vdupq_n_u8(static_cast<uint8_t>(needle[0]));
+                uint8x16_t const last = vdupq_n_u8(static_cast<uint8_t>(needle[needle_length - 1]));
+                size_t i = 0;
+                for (; i + 16 <= position_count; i += 16) {
+                    uint8x16_t const block_first = vld1q_u8(reinterpret_cast<uint8_t const*>(haystack + i));
+                    uint8x16_t const block_last = vld1q_u8(reinterpret_cast<uint8_t const*>(haystack + i + needle_length - 1));
+                    uint8x16_t const candidates = vandq_u8(vceqq_u8(block_first, first), vceqq_u8(block_last, last));
+                    // Narrowing gives a mask with 4 bits per byte
+                    uint64_t mask = vget_lane_u64(vreinterpret_u64_u8(vshrn_n_u16(vreinterpretq_u16_u8(candidates), 4)), 0) & 0x8888888888888888ull;
+                    for (; mask != 0; mask &= mask - 1) {
+                        size_t const position = i + simd_detail::count_trailing_zeros(mask) / 4;
+                        if (std::memcmp(haystack + position + 1, needle + 1, needle_length - 2) == 0) {
+                            found = true;
+                            return position;
+                        }
+                    }
+                }
+                return i;
+            }
+        }
+#endif // TUC_SIMD_NEON
+
+        // The needle needs to have at least 2 characters
+        inline size_t find_substring([[maybe_unused]] char const* haystack, [[maybe_unused]] size_t position_count, [[maybe_unused]] char const* needle, [[maybe_unused]] size_t needle_length, [[maybe_unused]] bool& found) {
+            switch (simd_detail::selected_instruction_set()) {
+#ifdef TUC_SIMD_X86
+            case simd_detail::instruction_set::avx2: return avx2::find_substring(haystack, position_count, needle, needle_length, found);
+            case simd_detail::instruction_set::sse2: return sse2::find_substring(haystack, position_count, needle, needle_length, found);
+#endif // TUC_SIMD_X86
+#ifdef TUC_SIMD_NEON
+            case simd_detail::instruction_set::neon: return neon::find_substring(haystack, position_count, needle, needle_length, found);
+#endif // TUC_SIMD_NEON
+            default: return 0;
+            }
+        }
+
+        // A precompiled substring searcher. For char, the SIMD kernels above do most of the work; the
+        // rest (the last partial vector, and wider characters) uses Horspool's algorithm, with the
+        // shift table indexed by the low byte of each character.
+        template <typename Char>
+        class searcher
+        {
+        public:
+            searcher(std::basic_string_view<Char> needle) : needle(needle) {
+                size_t const length = needle.length();
+                std::fill(std::begin(shifts), std::end(shifts), length);
+                for (size_t i = 0; i + 1 < length; ++i) {
+                    shifts[get_bucket(needle[i])] = length - 1 - i; // the later ones shift less, so win
+                }
+            }
+
+            // Returns the position of the first occurrence at or after from, or npos; like
+            // std::basic_string_view::find, an empty needle is found at from
+            size_t find(std::basic_string_view<Char> haystack, size_t from = 0) const {
+                size_t const needle_length = needle.length();
+                if (from > haystack.length() || haystack.length() - from < needle_length) {
+                    return std::basic_string_view<Char>::npos;
+                }
+                if (needle_length <= 1) {
+                    return needle_length == 0 ? from : haystack.find(needle[0], from);
+                }
+                if constexpr (sizeof(Char) == 1) {
+                    bool found = false;
+                    size_t const position_count = haystack.length() - from - needle_length + 1;
+                    from += find_substring(reinterpret_cast<char const*>(haystack.data() + from), position_count, reinterpret_cast<char const*>(needle.data()), needle_length, found);
+                    if (found) {
+                        return from;
+                    }
+                }
+                return find_horspool(haystack, from);
+            }
+
+            bool contains(std::basic_string_view<Char> haystack) const {
+                return find(haystack) != std::basic_string_view<Char>::npos;
+            }
+
+            std::basic_string_view<Char> get_needle() const {
+                return needle;
+            }
+
+        private:
+            size_t find_horspool(std::basic_string_view<Char> haystack, size_t from) const {
+                size_t const needle_length = needle.length();
+                Char const last = needle[needle_length - 1];
+                for (size_t i = from; i + needle_length <= haystack.length(); i += shifts[get_bucket(haystack[i + needle_length - 1])]) {
+                    if (haystack[i + needle_length - 1] == last && std::char_traits<Char>::compare(haystack.data() + i, needle.data(), needle_length - 1) == 0) {
+                        return i;
+                    }
+                }
+                return std::basic_string_view<Char>::npos;
+            }
+
+            static size_t get_bucket(Char c) {
+                return static_cast<std::make_unsigned_t<Char>>(c) & 0xFF;
+            }
+
+            std::basic_string<Char> const needle;
+            size_t shifts[256];
+        };
+
+        // The delimiter finders used by split: find(text, from) returns the position of the next
+        // delimiter (or npos), and get_length() the length of the delimiters. The delimiters are
+        // copied, so that they may be temporaries.
+
+        template <typename Char>
+        class character_finder
+        {
+        public:
+            character_finder(Char delimiter) : delimiter(delimiter) {}
+
+            size_t find(std::basic_string_view<Char> text, size_t from) const {
+                return text.find(delimiter, from);
+            }
+
+            size_t get_length() const { return 1; }
+
+        private:
+            Char const delimiter;
+        };
+
+        template <typename Char>
+        class substring_finder
+        {
+        public:
+            substring_finder(std::basic_string_view<Char> delimiter) : delimiter(delimiter) {}
+
+            // An empty delimiter is never found
+            size_t find(std::basic_string_view<Char> text, size_t from) const {
+                return get_length() == 0 ? std::basic_string_view<Char>::npos : delimiter.find(text, from);
+            }
+
+            size_t get_length() const { return delimiter.get_needle().length(); }
+
+        private:
+            searcher<Char> const delimiter;
+        };
+
+        template <typename Char>
+        class character_set_finder
+        {
+        public:
+            character_set_finder(std::basic_string_view<Char> delimiters) : delimiters(delimiters) {}
+
+            size_t find(std::basic_string_view<Char> text, size_t from) const {
+                return text.find_first_of(std::basic_string_view<Char>(delimiters), from);
+            }
+
+            size_t get_length() const { return 1; }
+
+        private:
+            std::basic_string<Char> const delimiters;
+        };
+
+        // For char, use a lookup table, and vectorize the search
+        template <>
+        class character_set_finder<char>
+        {
+        public:
+            character_set_finder(std::string_view delimiters) {
+                for (char const c : delimiters) {
+                    bool& is_delimiter = lookup[static_cast<unsigned char>(c)];
+                    if (!is_delimiter) {
+                        is_delimiter = true;
+                        unique_delimiters.push_back(c);
+                    }
+                }
+            }
+
+            size_t find(std::string_view text, size_t from) const {
+                char const* const data = text.data();
+                size_t const length = text.length();
+                size_t i = from;
+                while (i < length) {
+                    i += skip_none_of(data + i, length - i, unique_delimiters.data(), unique_delimiters.size());
+                    for (size_t const end = (std::min)(length, i + max_vector_size); i < end; ++i) {
+                        if (lookup[static_cast<unsigned char>(data[i])]) {
+                            return i;
+                        }
+                    }
+                }
+                return std::string_view::npos;
+            }
+
+            size_t get_length() const { return 1; }
+
+        private:
+            bool lookup[256] = {};
+            std::string unique_delimiters;
+        };
+
+        // To keep the transition tables of the automata below small, the characters are first mapped
+        // to classes: one for each character that appears in the patterns, and a shared one (0) for
+        // all the others.
+        template <typename Char>
+        class character_classes
+        {
+        public:
+            void add(Char c) {
+                if constexpr (sizeof(Char) == 1) {
+                    if (byte_classes.empty()) {
+                        byte_classes.resize(256, 0);
+                    }
+                    auto& byte_class = byte_classes[static_cast<unsigned char>(c)];
+                    if (byte_class == 0) {
+                        byte_class = count++;
+                    }
+                }
+                else if (wide_classes.emplace(c, count).second) {
+                    ++count;
+                }
+            }
+
+            size_t get(Char c) const {
+                if constexpr (sizeof(Char) == 1) {
+                    return byte_classes.empty() ? 0 : byte_classes[static_cast<unsigned char>(c)];
+                }
+                else {
+                    auto const i = wide_classes.find(c);
+                    return i == wide_classes.end() ? 0 : i->second;
+                }
+            }
+
+            size_t get_count() const {
+                return count;
+            }
+
+        private:
+            size_t count = 1;
+            std::vector<size_t> byte_classes;
+            std::unordered_map<Char, size_t> wide_classes;
+        };
+
+        // A multi-pattern matcher (Aho & Corasick, 1975), compiled into a DFA
+        template <typename Char>
+        class aho_corasick
+        {
+        public:
+            // Empty patterns never match
+            aho_corasick(std::vector<std::basic_string_view<Char>> const& patterns) {
+                for (auto const& pattern : patterns) {
+                    for (Char const c : pattern) {
+                        classes.add(c);
+                    }
+                }
+
+                // The trie
+                add_state(0);
+                for (size_t i = 0; i < patterns.size(); ++i) {
+                    pattern_lengths.push_back(patterns[i].length());
+                    if (patterns[i].empty()) {
+                        continue;
+                    }
+                    if constexpr (sizeof(Char) == 1) {
+                        if (first_characters.find(static_cast<char>(patterns[i][0])) == std::string::npos) {
+                            first_characters.push_back(static_cast<char>(patterns[i][0]));
+                        }
+                    }
+                    int state = 0;
+                    for (Char const c : patterns[i]) {
+                        size_t const transition = state * classes.get_count() + classes.get(c);
+                        if (transitions[transition] == 0) {
+                            int const next = add_state(depths[state] + 1); // may reallocate the transitions
+                            transitions[transition] = next;
+                        }
+                        state = transitions[transition];
+                    }
+                    if (longest_match[state] < 0) { // if there are duplicates, the first one wins
+                        longest_match[state] = static_cast<int>(i);
+                    }
+                }
+
+                // The failure links, breadth-first, turning the trie into a DFA
+                std::vector<int> failure_links(depths.size(), 0);
+                std::vector<int> queue;
+                size_t const class_count = classes.get_count();
+                for (size_t c = 0; c < class_count; ++c) {
+                    if (int const child = transitions[c]) {
+                        queue.push_back(child);
+                    }
+                }
+                for (size_t i = 0; i < queue.size(); ++i) {
+                    int const state = queue[i];
+                    int const failure_link = failure_links[state];
+                    if (longest_match[state] < 0) {
+                        longest_match[state] = longest_match[failure_link];
+                    }
+                    for (size_t c = 0; c < class_count; ++c) {
+                        int& next = transitions[state * class_count + c];
+                        int const fallback = transitions[failure_link * class_count + c];
+                        if (next == 0) {
+                            next = fallback;
+                        }
+                        else {
+                            failure_links[next] = fallback;
+                            queue.push_back(next);
+                        }
+                    }
+                }
+            }
+
+            // Finds the leftmost-longest non-overlapping matches: at each position, the longest matching
+            // pattern is reported, and the search continues after it. Calls found(position, pattern_index)
+            // for each match, and returns the number of matches.
+            template <typename Found>
+            size_t find_all(std::basic_string_view<Char> text, Found found) const {
+                size_t match_count = 0;
+                for (auto match = find_first(text, 0); match.second != npos; match = find_first(text, match.first + pattern_lengths[match.second])) {
+                    found(match.first, match.second);
+                    ++match_count;
+                }
+                return match_count;
+            }
+
+            // Returns the leftmost-longest match at or after from, as (position, pattern index), or
+            // (npos, npos)
+            std::pair<size_t, size_t> find_first(std::basic_string_view<Char> text, size_t from) const {
+                size_t const length = text.length();
+                int state = 0;
+                size_t match_position = npos;
+                int match = -1;
+                size_t next_skip = from;
+                for (size_t i = from; i < length; ++i) {
+                    if constexpr (sizeof(Char) == 1) {
+                        // The root only moves on the first characters of the patterns; once a vector
+                        // contains one, scan it before trying to skip again
+                        if (state == 0 && i >= next_skip) {
+                            i += skip_none_of(reinterpret_cast<char const*>(text.data() + i), length - i, first_characters.data(), first_characters.size());
+                            next_skip = i + max_vector_size;
+                            if (i == length) {
+                                break;
+                            }
+                        }
+                    }
+                    state = transitions[state * classes.get_count() + classes.get(text[i])];
+                    int const longest = longest_match[state];
+                    if (longest >= 0) {
+                        size_t const position = i + 1 - pattern_lengths[longest];
+                        if (match < 0 || position <= match_position) { // a later report with the same position is longer
+                            match_position = position;
+                            match = longest;
+                        }
+                    }
+                    // Can a leftmore or longer match still be in progress?
+                    if (match >= 0 && i + 1 - depths[state] > match_position) {
+                        break;
+                    }
+                }
+                if (match < 0) {
+                    return { npos, npos };
+                }
+                return { match_position, static_cast<size_t>(match) };
+            }
+
+            size_t get_pattern_length(size_t pattern_index) const {
+                return pattern_lengths[pattern_index];
+            }
+
+        private:
+            int add_state(size_t depth) {
+                transitions.resize(transitions.size() + classes.get_count(), 0);
+                depths.push_back(depth);
+                longest_match.push_back(-1);
+                return static_cast<int>(depths.size() - 1);
+            }
+
+            static size_t constexpr npos = std::basic_string_view<Char>::npos;
+
+            character_classes<Char> classes;
+            std::vector<int> transitions; // state * class count + class -> state; state 0 is the root
+            std::vector<size_t> depths;
+            std::vector<int> longest_match; // the longest pattern that is a suffix of each state, or -1
+            std::vector<size_t> pattern_lengths;
+            std::string first_characters; // unique, for skipping with SIMD (if there are few enough)
+        };
+
+        // A trie of the patterns, for finding those that a text starts with (or, if reversed, ends
+        // with), in time that depends only on the length of the text
+        template <typename Char>
+        class trie
+        {
+        public:
+            trie(std::vector<std::basic_string_view<Char>> const& patterns, bool reversed, bool case_insensitive)
+                : reversed(reversed)
+                , case_insensitive(case_insensitive)
+            {
+                for (auto const& pattern : patterns) {
+                    for (size_t j = 0; j < pattern.length(); ++j) {
+                        classes.add(get_character(pattern, j));
+                    }
+                }
+                add_state();
+                for (size_t i = 0; i < patterns.size(); ++i) {
+                    auto const& pattern = patterns[i];
+                    size_t const length = pattern.length();
+                    int state = 0;
+                    for (size_t j = 0; j < length; ++j) {
+                        size_t const transition = state * classes.get_count() + classes.get(get_character(pattern, j));
+                        if (transitions[transition] == 0) {
+                            int const next = add_state(); // may reallocate the transitions
+                            transitions[transition] = next;
+                        }
+                        state = transitions[transition];
+                    }
+                    if (pattern_indices[state] < 0) { // if there are duplicates, the first one wins
+                        pattern_indices[state] = static_cast<int>(i);
+                    }
+                }
+            }
+
+            // Calls found(pattern_index) for each pattern found, from the shortest, while it returns true
+            template <typename Found>
+            void find(std::basic_string_view<Char> text, Found found) const {
+                int state = 0;
+                size_t const length = text.length();
+                for (size_t j = 0; ; ++j) {
+                    int const pattern_index = pattern_indices[state];
+                    if (pattern_index >= 0 && !found(static_cast<size_t>(pattern_index))) {
+                        return;
+                    }
+                    if (j == length) {
+                        return;
+                    }
+                    state = transitions[state * classes.get_count() + classes.get(get_character(text, j))];
+                    if (state == 0) {
+                        return;
+                    }
+                }
+            }
+
+        private:
+            Char get_character(std::basic_string_view<Char> text, size_t j) const {
+                Char const c = text[reversed ? text.length() - 1 - j : j];
+                return case_insensitive ? fold_case(c) : c;
+            }
+
+            int add_state() {
+                transitions.resize(transitions.size() + classes.get_count(), 0);
+                pattern_indices.push_back(-1);
+                return static_cast<int>(pattern_indices.size() - 1);
+            }
+
+            bool const reversed;
+            bool const case_insensitive;
+            character_classes<Char> classes;
+            std::vector<int> transitions; // state * class count + class -> state; 0 (the root) for none
+            std::vector<int> pattern_indices; // the pattern ending at each state, or -1
+        };
+    }
+}
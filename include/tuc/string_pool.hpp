@@ -0,0 +1,189 @@
+#pragma once
+
+#include <algorithm>
+#include <cstdint>
+#include <functional> // std::hash
+#include <memory>
+#include <mutex>
+#include <shared_mutex>
+#include <string_view>
+#include <thread>
+#include <unordered_set>
+#include <vector>
+
+namespace tuc
+{
+    // Interns strings: each distinct string is stored once, in an arena of large blocks, and the
+    // views returned remain valid (and unchanged) as long as the pool. Views interned in the same pool
+    // are equal if and only if their data() pointers are, so they can be compared and hashed by
+    // pointer (see pointer_hash and pointer_equal). The stored strings are null-terminated.
+    template <typename Char>
+    class basic_string_pool
+    {
+    public:
+        using view_type = std::basic_string_view<Char>;
+
+        basic_string_pool(size_t initial_block_size = 4096)
+            : block_size((std::max)(initial_block_size, size_t(1)))
+        {}
+
+        view_type intern(view_type input)
+        {
+            auto const i = strings.find(input);
+            if (i != strings.end()) {
+                return *i;
+            }
+            Char* const data = allocate(input.length() + 1);
+            std::copy(input.begin(), input.end(), data);
+            data[input.length()] = Char();
+            view_type const interned(data, input.length());
+            strings.insert(interned);
+            return interned;
+        }
+
+        // Returns the interned string, or a view with a null data() pointer if there is none
+        view_type find(view_type input) const
+        {
+            auto const i = strings.find(input);
+            return i == strings.end() ? view_type() : *i;
+        }
+
+        size_t get_size() const
+        {
+            return strings.size();
+        }
+
+        // The number of characters allocated for the arena
+        size_t get_arena_size() const
+        {
+            return arena_size;
+        }
+
+        // Invalidates all the views returned
+        void clear()
+        {
+            strings.clear();
+            blocks.clear();
+            next = nullptr;
+            remaining = 0;
+            arena_size = 0;
+        }
+
+        struct pointer_hash
+        {
+            size_t operator()(view_type interned) const
+            {
+                return std::hash<Char const*>()(interned.data());
+            }
+        };
+
+        struct pointer_equal
+        {
+            bool operator()(view_type lhs, view_type rhs) const
+            {
+                return lhs.data() == rhs.data();
+            }
+        };
+
+    private:
+        // Bump allocation; strings that would waste much of a block get a block of their own
+        Char* allocate(size_t length)
+        {
+            if (length > remaining) {
+                if (length > block_size / 4) {
+                    blocks.emplace_back(new Char[length]);
+                    arena_size += length;
+                    return blocks.back().get();
+                }
+                blocks.emplace_back(new Char[block_size]);
+                arena_size += block_size;
+                next = blocks.back().get();
+                remaining = block_size;
+                block_size = (std::min)(block_size * 2, max_block_size);
+            }
+            Char* const data = next;
+            next += length;
+            remaining -= length;
+            return data;
+        }
+
+        static size_t constexpr max_block_size = 1 << 20;
+
+        std::unordered_set<view_type> strings;
+        std::vector<std::unique_ptr<Char[]>> blocks;
+        size_t block_size;
+        Char* next = nullptr;
+        size_t remaining = 0;
+        size_t arena_size = 0;
+    };
+
+    // For loading with many threads: the strings are distributed to shards by their hash, each with
+    // its own pool and lock. Already interned strings are found under a shared lock.
+    template <typename Char>
+    class basic_concurrent_string_pool
+    {
+    public:
+        using view_type = std::basic_string_view<Char>;
+        using pointer_hash = typename basic_string_pool<Char>::pointer_hash;
+        using pointer_equal = typename basic_string_pool<Char>::pointer_equal;
+
+        basic_concurrent_string_pool(size_t shard_count = 4 * (std::max)(std::thread::hardware_concurrency(), 1u))
+            : shard_count((std::max)(shard_count, size_t(1)))
+            , shards(new shard[this->shard_count])
+        {}
+
+        view_type intern(view_type input)
+        {
+            shard& s = get_shard(input);
+            {
+                std::shared_lock<std::shared_mutex> lock(s.mutex);
+                view_type const interned = s.pool.find(input);
+                if (interned.data() != nullptr) {
+                    return interned;
+                }
+            }
+            std::unique_lock<std::shared_mutex> lock(s.mutex);
+            return s.pool.intern(input);
+        }
+
+        view_type find(view_type input) const
+        {
+            shard& s = get_shard(input);
+            std::shared_lock<std::shared_mutex> lock(s.mutex);
+            return s.pool.find(input);
+        }
+
+        size_t get_size() const
+        {
+            size_t size = 0;
+            for (size_t i = 0; i < shard_count; ++i) {
+                std::shared_lock<std::shared_mutex> lock(shards[i].mutex);
+                size += shards[i].pool.get_size();
+            }
+            return size;
+        }
+
+    private:
+        struct alignas(64) shard // on separate cache lines
+        {
+            std::shared_mutex mutex;
+            basic_string_pool<Char> pool;
+        };
+
+        shard& get_shard(view_type input) const
+        {
+            // Mix the hash, so that the strings of a shard do not share the bits the pool's hash
+            // table may use
+            uint64_t const hash = static_cast<uint64_t>(std::hash<view_type>()(input)) * 0x9E3779B97F4A7C15ull;
+            return shards[static_cast<size_t>(hash >> 32) % shard_count];
+        }
+
+        size_t const shard_count;
+        std::unique_ptr<shard[]> const shards;
+    };
+
+    using string_pool = basic_string_pool<char>;
+    using wstring_pool = basic_string_pool<wchar_t>;
+    using concurrent_string_pool = basic_concurrent_string_pool<char>;
+    using concurrent_wstring_pool = basic_concurrent_string_pool<wchar_t>;
+}
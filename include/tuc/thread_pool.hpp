@@ -9,6 +9,9 @@
 #include <memory>
 #include <sstream>
 #include <functional>
+#include <iterator>
+#include <optional>
+#include <vector>
 
 namespace tuc
 {
@@ -262,9 +265,14 @@ namespace tuc
 
             auto const get_chunks = [](size_t task_count, size_t chunk_count) {
                 std::vector<chunk> chunks(chunk_count);
+                if (chunk_count == 0) {
+                    return chunks;
+                }
+
+                tuc::divider<size_t> const divider(chunk_count);
 
                 auto const get_chunk_start_index = [=](size_t chunk_index) {
-                    return tuc::divide_rounding_to_closest(chunk_index * task_count, chunk_count);
+                    return divider.divide_rounding_to_closest(chunk_index * task_count);
                 };
 
                 for (size_t i = 0; i < chunk_count; ++i) {
@@ -289,4 +297,141 @@ namespace tuc
     {
         return thread_pool::launch(launch_mode, tp, function, arguments...);
     }
+
+    namespace scan_detail {
+        template <typename T, typename InputIterator, typename OutputIterator, typename BinaryOperation>
+        constexpr bool has_simd_scan_v =
+            std::is_integral<T>::value && (sizeof(T) == 4 || sizeof(T) == 8)
+            && (std::is_same<BinaryOperation, std::plus<>>::value || std::is_same<BinaryOperation, std::plus<T>>::value)
+            && numeric_detail::is_contiguous_iterator_v<InputIterator> && std::is_same<numeric_detail::iterator_value_t<InputIterator>, T>::value
+            && numeric_detail::is_contiguous_iterator_v<OutputIterator> && std::is_same<numeric_detail::iterator_value_t<OutputIterator>, T>::value;
+
+        template <typename T, typename Iterator, typename BinaryOperation>
+        T reduce_block(Iterator begin, Iterator end, BinaryOperation op) {
+            T result = *begin;
+            for (++begin; begin != end; ++begin) {
+                result = op(result, *begin);
+            }
+            return result;
+        }
+
+        // Scans a block, continuing from `carry` (the result of the preceding elements) if there is one
+        template <typename T, typename InputIterator, typename OutputIterator, typename BinaryOperation>
+        void scan_block(InputIterator begin, InputIterator end, OutputIterator output, std::optional<T> carry, BinaryOperation op, bool inclusive) {
+            if (begin == end) {
+                return;
+            }
+            assert(carry || inclusive);
+            if (!carry) {
+                carry = *begin;
+                *output = *carry;
+                ++begin;
+                ++output;
+            }
+            T current = *carry;
+            if constexpr (has_simd_scan_v<T, InputIterator, OutputIterator, BinaryOperation>) {
+                if (begin != end) {
+                    auto const done = numeric_detail::simd_scan(&*begin, &*output, static_cast<size_t>(end - begin), current, inclusive);
+                    begin += done;
+                    output += done;
+                }
+            }
+            for (; begin != end; ++begin, ++output) {
+                T const value = *begin; // read before writing, in case the output is the input
+                if (inclusive) {
+                    current = op(current, value);
+                    *output = current;
+                }
+                else {
+                    *output = current;
+                    current = op(current, value);
+                }
+            }
+        }
+
+        // Waits for the remaining tasks also when leaving by an exception, as they refer to the locals
+        // of the caller. Declare after everything the tasks use.
+        template <typename Future>
+        class wait_for_all_guard
+        {
+        public:
+            wait_for_all_guard(std::vector<Future>& futures)
+                : futures(futures)
+            {}
+
+            ~wait_for_all_guard() {
+                for (auto& future : futures) {
+                    if (future.valid()) {
+                        future.wait();
+                    }
+                }
+            }
+
+        private:
+            std::vector<Future>& futures;
+        };
+
+        // The two-pass blocked algorithm: first reduce each block in parallel, then combine the
+        // block totals sequentially, and finally scan each block in parallel
+        template <typename T, typename InputIterator, typename OutputIterator, typename BinaryOperation>
+        OutputIterator scan(thread_pool& tp, InputIterator begin, InputIterator end, OutputIterator output, std::optional<T> init, BinaryOperation op, bool inclusive) {
+            size_t const count = std::distance(begin, end);
+            size_t constexpr min_block_size = 1 << 14;
+            size_t const block_count = (std::min)(tp.get_thread_count(), count / min_block_size);
+            if (block_count <= 1) {
+                scan_block(begin, end, output, init, op, inclusive);
+                return std::next(output, count);
+            }
+
+            tuc::divider<size_t> const divider(block_count);
+            auto const get_block_begin = [&](size_t block_index) {
+                return divider.divide_rounding_down(block_index * count);
+            };
+
+            std::vector<std::future<T>> block_totals;
+            wait_for_all_guard<std::future<T>> const block_totals_guard(block_totals);
+            for (size_t i = 0; i + 1 < block_count; ++i) { // the total of the last block isn't needed
+                block_totals.push_back(tp([&, i]() {
+                    return reduce_block<T>(std::next(begin, get_block_begin(i)), std::next(begin, get_block_begin(i + 1)), op);
+                }));
+            }
+
+            std::vector<std::optional<T>> carries(block_count);
+            carries[0] = init;
+            for (size_t i = 1; i < block_count; ++i) {
+                T const block_total = block_totals[i - 1].get();
+                carries[i] = carries[i - 1] ? op(*carries[i - 1], block_total) : block_total;
+            }
+
+            std::vector<std::future<void>> scans;
+            wait_for_all_guard<std::future<void>> const scans_guard(scans);
+            for (size_t i = 0; i < block_count; ++i) {
+                scans.push_back(tp([&, i]() {
+                    auto const block_begin = get_block_begin(i);
+                    scan_block(std::next(begin, block_begin), std::next(begin, get_block_begin(i + 1)), std::next(output, block_begin), carries[i], op, inclusive);
+                }));
+            }
+            for (auto& scan : scans) {
+                scan.get();
+            }
+            return std::next(output, count);
+        }
+    }
+
+    // Parallel prefix sums, like std::inclusive_scan and std::exclusive_scan, but running on the
+    // thread pool. The operation needs to be associative (but not commutative). The output may be
+    // the input. Integer sums of contiguous ranges are vectorized.
+    // Note that the calling thread waits for the pool, so do not call these from within its tasks.
+    template <typename InputIterator, typename OutputIterator, typename BinaryOperation = std::plus<>>
+    OutputIterator inclusive_scan(thread_pool& tp, InputIterator begin, InputIterator end, OutputIterator output, BinaryOperation op = BinaryOperation())
+    {
+        using T = typename std::iterator_traits<InputIterator>::value_type;
+        return scan_detail::scan(tp, begin, end, output, std::optional<T>(), op, true);
+    }
+
+    template <typename InputIterator, typename OutputIterator, typename T, typename BinaryOperation = std::plus<>>
+    OutputIterator exclusive_scan(thread_pool& tp, InputIterator begin, InputIterator end, OutputIterator output, T init, BinaryOperation op = BinaryOperation())
+    {
+        return scan_detail::scan(tp, begin, end, output, std::optional<T>(init), op, false);
+    }
 }
@@ -1,29 +1,68 @@
 #pragma once
 
-#include <cmath>
-#include <sstream>
-#include <iomanip>
+#include <charconv>
+#include <string>
+#include <string_view>
+#include <type_traits>
 #include "to_string_detail.hpp"
 
 namespace tuc
 { 
+    // Formats the number with (at least) precision significant digits, and at least min_precision
+    // decimals. Like std::to_chars, returns the end of the output, or std::errc::value_too_large.
     template <typename T>
-    std::string to_string(T number, int precision, int min_precision = 1)
+    std::to_chars_result to_chars(char* first, char* last, T number, int precision, int min_precision = 1)
     {
         static_assert(std::is_floating_point<T>::value, "Floating-point type required"); // doesn't really make a lot of sense for other types
-        int const actual_precision = (std::max)(precision + static_cast<int>(ceil(log10(1.0 / std::abs(detail::round(number, precision)))) - 1), min_precision);
-        std::ostringstream oss;
-        oss << std::fixed << std::setprecision(actual_precision) << number;
-        return oss.str();
+        int const actual_precision = (std::max)(detail::get_decimal_count(number, precision), min_precision);
+        return std::to_chars(first, last, number, std::chars_format::fixed, actual_precision);
     }
 
     template <typename T>
-    std::string to_percentage_string(T count, T total, int min_precision = 0)
+    void append_to_string(std::string& output, T number, int precision, int min_precision = 1)
+    {
+        detail::append(output, [&](char* first, char* last) { return to_chars(first, last, number, precision, min_precision); });
+    }
+
+    template <typename T>
+    std::string to_string(T number, int precision, int min_precision = 1)
+    {
+        return detail::to_string([&](char* first, char* last) { return to_chars(first, last, number, precision, min_precision); });
+    }
+
+    // Formats a whole column of numbers into output, separated by separator (e.g., "\n")
+    template <typename InputIterator>
+    void append_to_string(std::string& output, InputIterator begin, InputIterator end, std::string_view separator, int precision, int min_precision = 1)
+    {
+        for (auto i = begin; i != end; ++i) {
+            if (i != begin) {
+                output += separator;
+            }
+            append_to_string(output, *i, precision, min_precision);
+        }
+    }
+
+    // Formats count / total as a percentage, with enough decimals to tell apart each count
+    template <typename T>
+    std::to_chars_result to_percentage_chars(char* first, char* last, T count, T total, int min_precision = 0)
     {
         static_assert(std::is_integral<T>::value, "Integral type required");
-        int const precision = (std::max)(static_cast<int>(ceil(log10(total / 100.0))), min_precision);
-        std::ostringstream oss;
-        oss << std::fixed << std::setprecision(precision) << count * 100.0 / total;
-        return oss.str();
+        int precision = 0;
+        for (double limit = 100.0; limit < static_cast<double>(total); limit *= 10.0) {
+            ++precision;
+        }
+        return std::to_chars(first, last, count * 100.0 / total, std::chars_format::fixed, (std::max)(precision, min_precision));
+    }
+
+    template <typename T>
+    void append_percentage_string(std::string& output, T count, T total, int min_precision = 0)
+    {
+        detail::append(output, [&](char* first, char* last) { return to_percentage_chars(first, last, count, total, min_precision); });
+    }
+
+    template <typename T>
+    std::string to_percentage_string(T count, T total, int min_precision = 0)
+    {
+        return detail::to_string([&](char* first, char* last) { return to_percentage_chars(first, last, count, total, min_precision); });
     }
 }
@@ -2,19 +2,64 @@
 
 // To be included only via tuc/to_string.hpp
 
+#include <algorithm>
+#include <charconv>
+#include <cmath>
+#include <string>
+#include <system_error>
+
 namespace tuc
 { 
     namespace detail
     {
+        // The number of decimals to show min_significant_digits significant digits. The decimal
+        // exponent is that of the number rounded to these digits (so that, e.g., 9.99 rounded to 2
+        // digits counts as 10), which the scientific format of to_chars gives exactly. Zero and
+        // non-finite values have no significant digits, so they need no decimals (but min_precision).
         template <typename T>
-        T round(T value, int min_significant_digits)
+        int get_decimal_count(T value, int min_significant_digits)
+        {
+            if (!std::isfinite(value) || value == 0) {
+                return 0;
+            }
+            int const significant_digits = (std::min)((std::max)(min_significant_digits, 1), 50); // more digits cannot change the exponent
+            char buffer[128];
+            auto const result = std::to_chars(buffer, buffer + sizeof(buffer), value, std::chars_format::scientific, significant_digits - 1);
+            char const* exponent = std::find(buffer, result.ptr, 'e') + 1;
+            if (*exponent == '+') {
+                ++exponent; // not accepted by from_chars
+            }
+            int decimal_exponent = 0;
+            std::from_chars(exponent, result.ptr, decimal_exponent);
+            return min_significant_digits - 1 - decimal_exponent;
+        }
+
+        template <typename Format>
+        void append(std::string& output, Format format)
+        {
+            size_t const size = output.size();
+            for (size_t capacity = 64; ; capacity *= 4) {
+                output.resize(size + capacity);
+                auto const result = format(&output[size], &output[size] + capacity);
+                if (result.ec == std::errc()) {
+                    output.resize(result.ptr - output.data());
+                    return;
+                }
+            }
+        }
+
+        // Formats into a buffer on the stack, which is large enough for most numbers
+        template <typename Format>
+        std::string to_string(Format format)
         {
-            if (value == 0.0)
-            {
-                return 0.0;
+            char buffer[64];
+            auto const result = format(buffer, buffer + sizeof(buffer));
+            if (result.ec == std::errc()) {
+                return std::string(buffer, result.ptr);
             }
-            double const factor = std::pow(10.0, (std::max)(0.0, min_significant_digits - std::ceil(std::log10(std::abs(value)))));
-            return std::round(value * factor) / factor;
+            std::string output;
+            append(output, format);
+            return output;
         }
     }
 }
@@ -0,0 +1,516 @@
+#pragma once
+
+// To be included only via tuc/string.hpp
+
+#include "simd_detail.hpp"
+#include <algorithm> // std::min, std::upper_bound
+#include <cstddef>
+#include <cstdint>
+#include <iterator> // std::begin, std::end
+#include <stdexcept> // std::range_error
+#include <string>
+#include <string_view>
+#include <type_traits>
+
+namespace tuc
+{
+    namespace unicode_detail
+    {
+        // Unicode simple case folding (CaseFolding.txt, statuses C and S), as ranges of code points
+        // that fold to code point + delta; with a stride of 2, only every other one does (the upper
+        // case letters of the alternating pairs).
+        struct case_fold_range
+        {
+            uint32_t first;
+            uint32_t last;
+            int32_t delta;
+            uint32_t stride;
+        };
+
+        inline case_fold_range const case_fold_ranges[] = {
+            { 0x00B5, 0x00B5, 775, 1 }, { 0x00C0, 0x00D6, 32, 1 }, { 0x00D8, 0x00DE, 32, 1 }, { 0x0100, 0x012E, 1, 2 },
+            { 0x0132, 0x0136, 1, 2 }, { 0x0139, 0x0147, 1, 2 }, { 0x014A, 0x0176, 1, 2 }, { 0x0178, 0x0178, -121, 1 },
+            { 0x0179, 0x017D, 1, 2 }, { 0x017F, 0x017F, -268, 1 }, { 0x0181, 0x0181, 210, 1 },
+            { 0x0182, 0x0184, 1, 2 }, { 0x0186, 0x0186, 206, 1 }, { 0x0187, 0x0187, 1, 1 }, { 0x0189, 0x018A, 205, 1 },
+            { 0x018B, 0x018B, 1, 1 }, { 0x018E, 0x018E, 79, 1 }, { 0x018F, 0x018F, 202, 1 },
+            { 0x0190, 0x0190, 203, 1 }, { 0x0191, 0x0191, 1, 1 }, { 0x0193, 0x0193, 205, 1 },
+            { 0x0194, 0x0194, 207, 1 }, { 0x0196, 0x0196, 211, 1 }, { 0x0197, 0x0197, 209, 1 },
+            { 0x0198, 0x0198, 1, 1 }, { 0x019C, 0x019C, 211, 1 }, { 0x019D, 0x019D, 213, 1 },
+            { 0x019F, 0x019F, 214, 1 }, { 0x01A0, 0x01A4, 1, 2 }, { 0x01A6, 0x01A6, 218, 1 }, { 0x01A7, 0x01A7, 1, 1 },
+            { 0x01A9, 0x01A9, 218, 1 }, { 0x01AC, 0x01AC, 1, 1 }, { 0x01AE, 0x01AE, 218, 1 }, { 0x01AF, 0x01AF, 1, 1 },
+            { 0x01B1, 0x01B2, 217, 1 }, { 0x01B3, 0x01B5, 1, 2 }, { 0x01B7, 0x01B7, 219, 1 }, { 0x01B8, 0x01B8, 1, 1 },
+            { 0x01BC, 0x01BC, 1, 1 }, { 0x01C4, 0x01C4, 2, 1 }, { 0x01C5, 0x01C5, 1, 1 }, { 0x01C7, 0x01C7, 2, 1 },
+            { 0x01C8, 0x01C8, 1, 1 }, { 0x01CA, 0x01CA, 2, 1 }, { 0x01CB, 0x01DB, 1, 2 }, { 0x01DE, 0x01EE, 1, 2 },
+            { 0x01F1, 0x01F1, 2, 1 }, { 0x01F2, 0x01F4, 1, 2 }, { 0x01F6, 0x01F6, -97, 1 }, { 0x01F7, 0x01F7, -56, 1 },
+            { 0x01F8, 0x021E, 1, 2 }, { 0x0220, 0x0220, -130, 1 }, { 0x0222, 0x0232, 1, 2 },
+            { 0x023A, 0x023A, 10795, 1 }, { 0x023B, 0x023B, 1, 1 }, { 0x023D, 0x023D, -163, 1 },
+            { 0x023E, 0x023E, 10792, 1 }, { 0x0241, 0x0241, 1, 1 }, { 0x0243, 0x0243, -195, 1 },
+            { 0x0244, 0x0244, 69, 1 }, { 0x0245, 0x0245, 71, 1 }, { 0x0246, 0x024E, 1, 2 }, { 0x0345, 0x0345, 116, 1 },
+            { 0x0370, 0x0372, 1, 2 }, { 0x0376, 0x0376, 1, 1 }, { 0x037F, 0x037F, 116, 1 }, { 0x0386, 0x0386, 38, 1 },
+            { 0x0388, 0x038A, 37, 1 }, { 0x038C, 0x038C, 64, 1 }, { 0x038E, 0x038F, 63, 1 }, { 0x0391, 0x03A1, 32, 1 },
+            { 0x03A3, 0x03AB, 32, 1 }, { 0x03C2, 0x03C2, 1, 1 }, { 0x03CF, 0x03CF, 8, 1 }, { 0x03D0, 0x03D0, -30, 1 },
+            { 0x03D1, 0x03D1, -25, 1 }, { 0x03D5, 0x03D5, -15, 1 }, { 0x03D6, 0x03D6, -22, 1 },
+            { 0x03D8, 0x03EE, 1, 2 }, { 0x03F0, 0x03F0, -54, 1 }, { 0x03F1, 0x03F1, -48, 1 },
+            { 0x03F4, 0x03F4, -60, 1 }, { 0x03F5, 0x03F5, -64, 1 }, { 0x03F7, 0x03F7, 1, 1 },
+            { 0x03F9, 0x03F9, -7, 1 }, { 0x03FA, 0x03FA, 1, 1 }, { 0x03FD, 0x03FF, -130, 1 },
+            { 0x0400, 0x040F, 80, 1 }, { 0x0410, 0x042F, 32, 1 }, { 0x0460, 0x0480, 1, 2 }, { 0x048A, 0x04BE, 1, 2 },
+            { 0x04C0, 0x04C0, 15, 1 }, { 0x04C1, 0x04CD, 1, 2 }, { 0x04D0, 0x052E, 1, 2 }, { 0x0531, 0x0556, 48, 1 },
+            { 0x10A0, 0x10C5, 7264, 1 }, { 0x10C7, 0x10C7, 7264, 1 }, { 0x10CD, 0x10CD, 7264, 1 },
+            { 0x13A0, 0x13EF, 38864, 1 }, { 0x13F0, 0x13F5, 8, 1 }, { 0x1C80, 0x1C80, -6222, 1 },
+            { 0x1C81, 0x1C81, -6221, 1 }, { 0x1C82, 0x1C82, -6212, 1 }, { 0x1C83, 0x1C84, -6210, 1 },
+            { 0x1C85, 0x1C85, -6211, 1 }, { 0x1C86, 0x1C86, -6204, 1 }, { 0x1C87, 0x1C87, -6180, 1 },
+            { 0x1C88, 0x1C88, 35267, 1 }, { 0x1C90, 0x1CBA, -3008, 1 }, { 0x1CBD, 0x1CBF, -3008, 1 },
+            { 0x1E00, 0x1E94, 1, 2 }, { 0x1E9B, 0x1E9B, -58, 1 }, { 0x1E9E, 0x1E9E, -7615, 1 },
+            { 0x1EA0, 0x1EFE, 1, 2 }, { 0x1F08, 0x1F0F, -8, 1 }, { 0x1F18, 0x1F1D, -8, 1 }, { 0x1F28, 0x1F2F, -8, 1 },
+            { 0x1F38, 0x1F3F, -8, 1 }, { 0x1F48, 0x1F4D, -8, 1 }, { 0x1F59, 0x1F5F, -8, 2 }, { 0x1F68, 0x1F6F, -8, 1 },
+            { 0x1F88, 0x1F8F, -8, 1 }, { 0x1F98, 0x1F9F, -8, 1 }, { 0x1FA8, 0x1FAF, -8, 1 }, { 0x1FB8, 0x1FB9, -8, 1 },
+            { 0x1FBA, 0x1FBB, -74, 1 }, { 0x1FBC, 0x1FBC, -9, 1 }, { 0x1FBE, 0x1FBE, -7173, 1 },
+            { 0x1FC8, 0x1FCB, -86, 1 }, { 0x1FCC, 0x1FCC, -9, 1 }, { 0x1FD8, 0x1FD9, -8, 1 },
+            { 0x1FDA, 0x1FDB, -100, 1 }, { 0x1FE8, 0x1FE9, -8, 1 }, { 0x1FEA, 0x1FEB, -112, 1 },
+            { 0x1FEC, 0x1FEC, -7, 1 }, { 0x1FF8, 0x1FF9, -128, 1 }, { 0x1FFA, 0x1FFB, -126, 1 },
+            { 0x1FFC, 0x1FFC, -9, 1 }, { 0x2126, 0x2126, -7517, 1 }, { 0x212A, 0x212A, -8383, 1 },
+            { 0x212B, 0x212B, -8262, 1 }, { 0x2132, 0x2132, 28, 1 }, { 0x2160, 0x216F, 16, 1 },
+            { 0x2183, 0x2183, 1, 1 }, { 0x24B6, 0x24CF, 26, 1 }, { 0x2C00, 0x2C2F, 48, 1 }, { 0x2C60, 0x2C60, 1, 1 },
+            { 0x2C62, 0x2C62, -10743, 1 }, { 0x2C63, 0x2C63, -3814, 1 }, { 0x2C64, 0x2C64, -10727, 1 },
+            { 0x2C67, 0x2C6B, 1, 2 }, { 0x2C6D, 0x2C6D, -10780, 1 }, { 0x2C6E, 0x2C6E, -10749, 1 },
+            { 0x2C6F, 0x2C6F, -10783, 1 }, { 0x2C70, 0x2C70, -10782, 1 }, { 0x2C72, 0x2C72, 1, 1 },
+            { 0x2C75, 0x2C75, 1, 1 }, { 0x2C7E, 0x2C7F, -10815, 1 }, { 0x2C80, 0x2CE2, 1, 2 },
+            { 0x2CEB, 0x2CED, 1, 2 }, { 0x2CF2, 0x2CF2, 1, 1 }, { 0xA640, 0xA66C, 1, 2 }, { 0xA680, 0xA69A, 1, 2 },
+            { 0xA722, 0xA72E, 1, 2 }, { 0xA732, 0xA76E, 1, 2 }, { 0xA779, 0xA77B, 1, 2 },
+            { 0xA77D, 0xA77D, -35332, 1 }, { 0xA77E, 0xA786, 1, 2 }, { 0xA78B, 0xA78B, 1, 1 },
+            { 0xA78D, 0xA78D, -42280, 1 }, { 0xA790, 0xA792, 1, 2 }, { 0xA796, 0xA7A8, 1, 2 },
+            { 0xA7AA, 0xA7AA, -42308, 1 }, { 0xA7AB, 0xA7AB, -42319, 1 }, { 0xA7AC, 0xA7AC, -42315, 1 },
+            { 0xA7AD, 0xA7AD, -42305, 1 }, { 0xA7AE, 0xA7AE, -42308, 1 }, { 0xA7B0, 0xA7B0, -42258, 1 },
+            { 0xA7B1, 0xA7B1, -42282, 1 }, { 0xA7B2, 0xA7B2, -42261, 1 }, { 0xA7B3, 0xA7B3, 928, 1 },
+            { 0xA7B4, 0xA7C2, 1, 2 }, { 0xA7C4, 0xA7C4, -48, 1 }, { 0xA7C5, 0xA7C5, -42307, 1 },
+            { 0xA7C6, 0xA7C6, -35384, 1 }, { 0xA7C7, 0xA7C9, 1, 2 }, { 0xA7D0, 0xA7D0, 1, 1 },
+            { 0xA7D6, 0xA7D8, 1, 2 }, { 0xA7F5, 0xA7F5, 1, 1 }, { 0xFF21, 0xFF3A, 32, 1 }, { 0x10400, 0x10427, 40, 1 },
+            { 0x104B0, 0x104D3, 40, 1 }, { 0x10570, 0x1057A, 39, 1 }, { 0x1057C, 0x1058A, 39, 1 },
+            { 0x1058C, 0x10592, 39, 1 }, { 0x10594, 0x10595, 39, 1 }, { 0x10C80, 0x10CB2, 64, 1 },
+            { 0x118A0, 0x118BF, 32, 1 }, { 0x16E40, 0x16E5F, 32, 1 }, { 0x1E900, 0x1E921, 34, 1 }
+        };
+
+        inline char32_t fold_case(char32_t c) {
+            if (c < 0x80) {
+                return c >= 'A' && c <= 'Z' ? c | 0x20 : c;
+            }
+            auto const range = std::upper_bound(std::begin(case_fold_ranges), std::end(case_fold_ranges), c, [](char32_t c, case_fold_range const& range) {
+                return c < range.first;
+            });
+            if (range == std::begin(case_fold_ranges)) {
+                return c;
+            }
+            auto const& candidate = *(range - 1);
+            if (c > candidate.last || (c - candidate.first) % candidate.stride != 0) {
+                return c;
+            }
+            return static_cast<char32_t>(static_cast<int32_t>(c) + candidate.delta);
+        }
+
+        char32_t constexpr replacement_character = 0xFFFD;
+        char32_t constexpr invalid_code_point = 0xFFFFFFFF;
+
+        // The SIMD kernels convert (or skip) the ASCII characters of full vectors between UTF-8 and
+        // UTF-16 or UTF-32, stopping at the first vector with any other character, and return the
+        // number of characters processed.
+        size_t constexpr max_vector_size = 32;
+
+#ifdef TUC_SIMD_X86
+        namespace sse2
+        {
+            template <typename Output>
+            size_t ascii_from_utf8(char const* input, Output* output, size_t count) {
+                __m128i const zero = _mm_setzero_si128();
+                size_t i = 0;
+                for (; i + 16 <= count; i += 16) {
+                    __m128i const x = _mm_loadu_si128(reinterpret_cast<__m128i const*>(input + i));
+                    if (_mm_movemask_epi8(x) != 0) {
+                        break;
+                    }
+                    __m128i const low = _mm_unpacklo_epi8(x, zero);
+                    __m128i const high = _mm_unpackhi_epi8(x, zero);
+                    if constexpr (sizeof(Output) == 2) {
+                        _mm_storeu_si128(reinterpret_cast<__m128i*>(output + i), low);
+                        _mm_storeu_si128(reinterpret_cast<__m128i*>(output + i + 8), high);
+                    }
+                    else {
+                        _mm_storeu_si128(reinterpret_cast<__m128i*>(output + i), _mm_unpacklo_epi16(low, zero));
+                        _mm_storeu_si128(reinterpret_cast<__m128i*>(output + i + 4), _mm_unpackhi_epi16(low, zero));
+                        _mm_storeu_si128(reinterpret_cast<__m128i*>(output + i + 8), _mm_unpacklo_epi16(high, zero));
+                        _mm_storeu_si128(reinterpret_cast<__m128i*>(output + i + 12), _mm_unpackhi_epi16(high, zero));
+                    }
+                }
+                return i;
+            }
+
+            inline size_t skip_ascii(char const* input, size_t count) {
+                size_t i = 0;
+                for (; i + 16 <= count && _mm_movemask_epi8(_mm_loadu_si128(reinterpret_cast<__m128i const*>(input + i))) == 0; i += 16) {}
+                return i;
+            }
+
+            template <typename Input>
+            size_t ascii_to_utf8(Input const* input, char* output, size_t count) {
+                __m128i const zero = _mm_setzero_si128();
+                size_t i = 0;
+                for (; i + 16 <= count; i += 16) {
+                    __m128i packed;
+                    if constexpr (sizeof(Input) == 2) {
+                        __m128i const a = _mm_loadu_si128(reinterpret_cast<__m128i const*>(input + i));
+                        __m128i const b = _mm_loadu_si128(reinterpret_cast<__m128i const*>(input + i + 8));
+                        __m128i const non_ascii = _mm_and_si128(_mm_or_si128(a, b), _mm_set1_epi16(static_cast<short>(0xFF80)));
+                        if (_mm_movemask_epi8(_mm_cmpeq_epi16(non_ascii, zero)) != 0xFFFF) {
+                            break;
+                        }
+                        packed = _mm_packus_epi16(a, b);
+                    }
+                    else {
+                        __m128i const a = _mm_loadu_si128(reinterpret_cast<__m128i const*>(input + i));
+                        __m128i const b = _mm_loadu_si128(reinterpret_cast<__m128i const*>(input + i + 4));
+                        __m128i const c = _mm_loadu_si128(reinterpret_cast<__m128i const*>(input + i + 8));
+                        __m128i const d = _mm_loadu_si128(reinterpret_cast<__m128i const*>(input + i + 12));
+                        __m128i const non_ascii = _mm_and_si128(_mm_or_si128(_mm_or_si128(a, b), _mm_or_si128(c, d)), _mm_set1_epi32(static_cast<int>(0xFFFFFF80)));
+                        if (_mm_movemask_epi8(_mm_cmpeq_epi32(non_ascii, zero)) != 0xFFFF) {
+                            break;
+                        }
+                        packed = _mm_packus_epi16(_mm_packs_epi32(a, b), _mm_packs_epi32(c, d));
+                    }
+                    _mm_storeu_si128(reinterpret_cast<__m128i*>(output + i), packed);
+                }
+                return i;
+            }
+        }
+
+        namespace avx2
+        {
+            template <typename Output>
+            TUC_SIMD_TARGET_AVX2 size_t ascii_from_utf8(char const* input, Output* output, size_t count) {
+                size_t i = 0;
+                for (; i + 32 <= count; i += 32) {
+                    __m256i const x = _mm256_loadu_si256(reinterpret_cast<__m256i const*>(input + i));
+                    if (_mm256_movemask_epi8(x) != 0) {
+                        break;
+                    }
+                    __m128i const low = _mm256_castsi256_si128(x);
+                    __m128i const high = _mm256_extracti128_si256(x, 1);
+                    if constexpr (sizeof(Output) == 2) {
+                        _mm256_storeu_si256(reinterpret_cast<__m256i*>(output + i), _mm256_cvtepu8_epi16(low));
+                        _mm256_storeu_si256(reinterpret_cast<__m256i*>(output + i + 16), _mm256_cvtepu8_epi16(high));
+                    }
+                    else {
+                        _mm256_storeu_si256(reinterpret_cast<__m256i*>(output + i), _mm256_cvtepu8_epi32(low));
+                        _mm256_storeu_si256(reinterpret_cast<__m256i*>(output + i + 8), _mm256_cvtepu8_epi32(_mm_srli_si128(low, 8)));
+                        _mm256_storeu_si256(reinterpret_cast<__m256i*>(output + i + 16), _mm256_cvtepu8_epi32(high));
+                        _mm256_storeu_si256(reinterpret_cast<__m256i*>(output + i + 24), _mm256_cvtepu8_epi32(_mm_srli_si128(high, 8)));
+                    }
+                }
+                return i;
+            }
+
+            TUC_SIMD_TARGET_AVX2 inline size_t skip_ascii(char const* input, size_t count) {
+                size_t i = 0;
+                for (; i + 32 <= count && _mm256_movemask_epi8(_mm256_loadu_si256(reinterpret_cast<__m256i const*>(input + i))) == 0; i += 32) {}
+                return i;
+            }
+
+            template <typename Input>
+            TUC_SIMD_TARGET_AVX2 size_t ascii_to_utf8(Input const* input, char* output, size_t count) {
+                size_t i = 0;
+                for (; i + 32 <= count; i += 32) {
+                    __m256i packed;
+                    if constexpr (sizeof(Input) == 2) {
+                        __m256i const a = _mm256_loadu_si256(reinterpret_cast<__m256i const*>(input + i));
+                        __m256i const b = _mm256_loadu_si256(reinterpret_cast<__m256i const*>(input + i + 16));
+                        if (!_mm256_testz_si256(_mm256_or_si256(a, b), _mm256_set1_epi16(static_cast<short>(0xFF80)))) {
+                            break;
+                        }
+                        packed = _mm256_permute4x64_epi64(_mm256_packus_epi16(a, b), 0xD8); // packing works within lanes
+                    }
+                    else {
+                        __m256i const a = _mm256_loadu_si256(reinterpret_cast<__m256i const*>(input + i));
+                        __m256i const b = _mm256_loadu_si256(reinterpret_cast<__m256i const*>(input + i + 8));
+                        __m256i const c = _mm256_loadu_si256(reinterpret_cast<__m256i const*>(input + i + 16));
+                        __m256i const d = _mm256_loadu_si256(reinterpret_cast<__m256i const*>(input + i + 24));
+                        if (!_mm256_testz_si256(_mm256_or_si256(_mm256_or_si256(a, b), _mm256_or_si256(c, d)), _mm256_set1_epi32(static_cast<int>(0xFFFFFF80)))) {
+                            break;
+                        }
+                        __m256i const interleaved = _mm256_packus_epi16(_mm256_packs_epi32(a, b), _mm256_packs_epi32(c, d));
+                        packed = _mm256_permutevar8x32_epi32(interleaved, _mm256_setr_epi32(0, 4, 1, 5, 2, 6, 3, 7));
+                    }
+                    _mm256_storeu_si256(reinterpret_cast<__m256i*>(output + i), packed);
+                }
+                return i;
+            }
+        }
+#endif // TUC_SIMD_X86
+
+#ifdef TUC_SIMD_NEON
+        namespace neon
+        {
+            template <typename Output>
+            size_t ascii_from_utf8(char const* input, Output* output, size_t count) {
+                size_t i = 0;
+                for (; i + 16 <= count; i += 16) {
+                    uint8x16_t const x = vld1q_u8(reinterpret_cast<uint8_t const*>(input + i));
+                    if (vmaxvq_u8(x) >= 0x80) {
+                        break;
+                    }
+                    uint16x8_t const low = vmovl_u8(vget_low_u8(x));
+                    uint16x8_t const high = vmovl_u8(vget_high_u8(x));
+                    if constexpr (sizeof(Output) == 2) {
+                        vst1q_u16(reinterpret_cast<uint16_t*>(output + i), low);
+                        vst1q_u16(reinterpret_cast<uint16_t*>(output + i + 8), high);
+                    }
+                    else {
+                        vst1q_u32(reinterpret_cast<uint32_t*>(output + i), vmovl_u16(vget_low_u16(low)));
+                        vst1q_u32(reinterpret_cast<uint32_t*>(output + i + 4), vmovl_u16(vget_high_u16(low)));
+                        vst1q_u32(reinterpret_cast<uint32_t*>(output + i + 8), vmovl_u16(vget_low_u16(high)));
+                        vst1q_u32(reinterpret_cast<uint32_t*>(output + i + 12), vmovl_u16(vget_high_u16(high)));
+                    }
+                }
+                return i;
+            }
+
+            inline size_t skip_ascii(char const* input, size_t count) {
+                size_t i = 0;
+                for (; i + 16 <= count && vmaxvq_u8(vld1q_u8(reinterpret_cast<uint8_t const*>(input + i))) < 0x80; i += 16) {}
+                return i;
+            }
+
+            template <typename Input>
+            size_t ascii_to_utf8(Input const* input, char* output, size_t count) {
+                size_t i = 0;
+                for (; i + 16 <= count; i += 16) {
+                    uint8x16_t packed;
+                    if constexpr (sizeof(Input) == 2) {
+                        uint16x8_t const a = vld1q_u16(reinterpret_cast<uint16_t const*>(input + i));
+                        uint16x8_t const b = vld1q_u16(reinterpret_cast<uint16_t const*>(input + i + 8));
+                        if (vmaxvq_u16(vorrq_u16(a, b)) >= 0x80) {
+                            break;
+                        }
+                        packed = vcombine_u8(vmovn_u16(a), vmovn_u16(b));
+                    }
+                    else {
+                        uint32x4_t const a = vld1q_u32(reinterpret_cast<uint32_t const*>(input + i));
+                        uint32x4_t const b = vld1q_u32(reinterpret_cast<uint32_t const*>(input + i + 4));
+                        uint32x4_t const c = vld1q_u32(reinterpret_cast<uint32_t const*>(input + i + 8));
+                        uint32x4_t const d = vld1q_u32(reinterpret_cast<uint32_t const*>(input + i + 12));
+                        if (vmaxvq_u32(vorrq_u32(vorrq_u32(a, b), vorrq_u32(c, d))) >= 0x80) {
+                            break;
+                        }
+                        uint16x8_t const ab = vcombine_u16(vmovn_u32(a), vmovn_u32(b));
+                        uint16x8_t const cd = vcombine_u16(vmovn_u32(c), vmovn_u32(d));
+                        packed = vcombine_u8(vmovn_u16(ab), vmovn_u16(cd));
+                    }
+                    vst1q_u8(reinterpret_cast<uint8_t*>(output + i), packed);
+                }
+                return i;
+            }
+        }
+#endif // TUC_SIMD_NEON
+
+        template <typename Output>
+        size_t ascii_from_utf8([[maybe_unused]] char const* input, [[maybe_unused]] Output* output, [[maybe_unused]] size_t count) {
+            switch (simd_detail::selected_instruction_set()) {
+#ifdef TUC_SIMD_X86
+            case simd_detail::instruction_set::avx2: return avx2::ascii_from_utf8(input, output, count);
+            case simd_detail::instruction_set::sse2: return sse2::ascii_from_utf8(input, output, count);
+#endif // TUC_SIMD_X86
+#ifdef TUC_SIMD_NEON
+            case simd_detail::instruction_set::neon: return neon::ascii_from_utf8(input, output, count);
+#endif // TUC_SIMD_NEON
+            default: return 0;
+            }
+        }
+
+        inline size_t skip_ascii([[maybe_unused]] char const* input, [[maybe_unused]] size_t count) {
+            switch (simd_detail::selected_instruction_set()) {
+#ifdef TUC_SIMD_X86
+            case simd_detail::instruction_set::avx2: return avx2::skip_ascii(input, count);
+            case simd_detail::instruction_set::sse2: return sse2::skip_ascii(input, count);
+#endif // TUC_SIMD_X86
+#ifdef TUC_SIMD_NEON
+            case simd_detail::instruction_set::neon: return neon::skip_ascii(input, count);
+#endif // TUC_SIMD_NEON
+            default: return 0;
+            }
+        }
+
+        template <typename Input>
+        size_t ascii_to_utf8([[maybe_unused]] Input const* input, [[maybe_unused]] char* output, [[maybe_unused]] size_t count) {
+            switch (simd_detail::selected_instruction_set()) {
+#ifdef TUC_SIMD_X86
+            case simd_detail::instruction_set::avx2: return avx2::ascii_to_utf8(input, output, count);
+            case simd_detail::instruction_set::sse2: return sse2::ascii_to_utf8(input, output, count);
+#endif // TUC_SIMD_X86
+#ifdef TUC_SIMD_NEON
+            case simd_detail::instruction_set::neon: return neon::ascii_to_utf8(input, output, count);
+#endif // TUC_SIMD_NEON
+            default: return 0;
+            }
+        }
+
+        // Decodes the code point at the beginning of input (count > 0), and sets length to the number
+        // of code units read. Returns invalid_code_point for an ill-formed sequence, of which length is
+        // the maximal subpart (so that each is replaced by a single U+FFFD, as recommended by Unicode).
+        inline char32_t decode(char const* input, size_t count, size_t& length) {
+            auto const byte = [input](size_t i) { return static_cast<unsigned char>(input[i]); };
+            unsigned char const lead = byte(0);
+            length = 1;
+            if (lead < 0x80) {
+                return lead;
+            }
+            size_t trail_count;
+            unsigned char low = 0x80; // the range of the first trailing byte, which excludes overlong
+            unsigned char high = 0xBF; // encodings, surrogates and code points over U+10FFFF
+            char32_t code_point;
+            if (lead < 0xC2) {
+                return invalid_code_point;
+            }
+            else if (lead < 0xE0) {
+                trail_count = 1;
+                code_point = lead & 0x1F;
+            }
+            else if (lead < 0xF0) {
+                trail_count = 2;
+                code_point = lead & 0x0F;
+                low = lead == 0xE0 ? 0xA0 : 0x80;
+                high = lead == 0xED ? 0x9F : 0xBF;
+            }
+            else if (lead < 0xF5) {
+                trail_count = 3;
+                code_point = lead & 0x07;
+                low = lead == 0xF0 ? 0x90 : 0x80;
+                high = lead == 0xF4 ? 0x8F : 0xBF;
+            }
+            else {
+                return invalid_code_point;
+            }
+            for (size_t i = 1; i <= trail_count; ++i) {
+                if (i >= count || byte(i) < low || byte(i) > high) {
+                    return invalid_code_point;
+                }
+                code_point = (code_point << 6) | (byte(i) & 0x3F);
+                length = i + 1;
+                low = 0x80;
+                high = 0xBF;
+            }
+            return code_point;
+        }
+
+        template <typename Char>
+        char32_t decode(Char const* input, size_t count, size_t& length) {
+            char32_t const unit = static_cast<char32_t>(static_cast<std::make_unsigned_t<Char>>(input[0]));
+            length = 1;
+            if constexpr (sizeof(Char) == 2) {
+                if (unit >= 0xD800 && unit < 0xDC00 && count > 1) {
+                    char32_t const trail = static_cast<char32_t>(static_cast<std::make_unsigned_t<Char>>(input[1]));
+                    if (trail >= 0xDC00 && trail < 0xE000) {
+                        length = 2;
+                        return 0x10000 + ((unit - 0xD800) << 10) + (trail - 0xDC00);
+                    }
+                }
+            }
+            if ((unit >= 0xD800 && unit < 0xE000) || unit > 0x10FFFF) {
+                return invalid_code_point;
+            }
+            return unit;
+        }
+
+        // Returns the number of code units written
+        inline size_t encode(char32_t code_point, char* output) {
+            if (code_point < 0x80) {
+                output[0] = static_cast<char>(code_point);
+                return 1;
+            }
+            if (code_point < 0x800) {
+                output[0] = static_cast<char>(0xC0 | (code_point >> 6));
+                output[1] = static_cast<char>(0x80 | (code_point & 0x3F));
+                return 2;
+            }
+            if (code_point < 0x10000) {
+                output[0] = static_cast<char>(0xE0 | (code_point >> 12));
+                output[1] = static_cast<char>(0x80 | ((code_point >> 6) & 0x3F));
+                output[2] = static_cast<char>(0x80 | (code_point & 0x3F));
+                return 3;
+            }
+            output[0] = static_cast<char>(0xF0 | (code_point >> 18));
+            output[1] = static_cast<char>(0x80 | ((code_point >> 12) & 0x3F));
+            output[2] = static_cast<char>(0x80 | ((code_point >> 6) & 0x3F));
+            output[3] = static_cast<char>(0x80 | (code_point & 0x3F));
+            return 4;
+        }
+
+        template <typename Char>
+        size_t encode(char32_t code_point, Char* output) {
+            if constexpr (sizeof(Char) == 2) {
+                if (code_point >= 0x10000) {
+                    output[0] = static_cast<Char>(0xD800 + ((code_point - 0x10000) >> 10));
+                    output[1] = static_cast<Char>(0xDC00 + ((code_point - 0x10000) & 0x3FF));
+                    return 2;
+                }
+            }
+            output[0] = static_cast<Char>(code_point);
+            return 1;
+        }
+
+        template <typename Char>
+        [[noreturn]] void throw_invalid(size_t position) {
+            throw std::range_error(std::string(sizeof(Char) == 1 ? "Invalid UTF-8" : sizeof(Char) == 2 ? "Invalid UTF-16" : "Invalid UTF-32") + " at code unit " + std::to_string(position));
+        }
+
+        // Transcodes between UTF-8, UTF-16 and UTF-32 (by the size of the code units). Ill-formed
+        // sequences are replaced by U+FFFD, or throw std::range_error.
+        template <typename Output, typename Input>
+        std::basic_string<Output> transcode(std::basic_string_view<Input> input, bool replace_invalid) {
+            static_assert(sizeof(Input) == 1 || sizeof(Output) == 1, "Only conversions from or to UTF-8 are supported");
+            size_t const max_expansion = sizeof(Output) == 1 ? (sizeof(Input) == 2 ? 3 : 4) : 1;
+            std::basic_string<Output> output(input.length() * max_expansion, Output());
+            size_t const count = input.length();
+            size_t i = 0;
+            size_t o = 0;
+            while (i < count) {
+                if constexpr (sizeof(Input) == 1) {
+                    size_t const ascii_count = ascii_from_utf8(input.data() + i, &output[o], count - i);
+                    i += ascii_count;
+                    o += ascii_count;
+                }
+                else {
+                    size_t const ascii_count = ascii_to_utf8(input.data() + i, &output[o], count - i);
+                    i += ascii_count;
+                    o += ascii_count;
+                }
+                for (size_t const end = (std::min)(count, i + max_vector_size); i < end; ) {
+                    size_t length;
+                    char32_t code_point = decode(input.data() + i, count - i, length);
+                    if (code_point == invalid_code_point) {
+                        if (!replace_invalid) {
+                            throw_invalid<Input>(i);
+                        }
+                        code_point = replacement_character;
+                    }
+                    i += length;
+                    o += encode(code_point, &output[o]);
+                }
+            }
+            output.resize(o);
+            return output;
+        }
+
+        inline bool is_valid_utf8(std::string_view input) {
+            size_t const count = input.length();
+            size_t i = 0;
+            while (i < count) {
+                i += skip_ascii(input.data() + i, count - i);
+                for (size_t const end = (std::min)(count, i + max_vector_size); i < end; ) {
+                    size_t length;
+                    if (decode(input.data() + i, count - i, length) == invalid_code_point) {
+                        return false;
+                    }
+                    i += length;
+                }
+            }
+            return true;
+        }
+    }
+}
@@ -4,6 +4,11 @@ struct IUnknown; // Workaround for "combaseapi.h(229): error C2187: syntax error
 #include "picotest/picotest.h"
 #include <stdio.h>
 #include <fstream>
+#include <algorithm>
+#include <chrono>
+#include <mutex>
+#include <string>
+#include <vector>
 
 namespace {
 
@@ -42,4 +47,196 @@ namespace {
         EXPECT_FALSE(tuc::fs::exists(test));
     }
 
+    TEST_F(FilesystemTest, RemovesEmptyDirectoriesRecursivelyInParallel) {
+        tuc::fs::path test("filesystem-parallel-test-directory");
+        for (int i = 0; i < 20; ++i) {
+            for (int j = 0; j < 5; ++j) {
+                tuc::fs::create_directories(test / std::to_string(i) / std::to_string(j) / "empty");
+            }
+            if (i % 4 == 0) {
+                std::ofstream out(test / std::to_string(i) / "3" / "test.txt");
+                out << "test file";
+            }
+        }
+
+        tuc::thread_pool tp(4);
+        EXPECT_EQ(tuc::remove_empty_directories_recursively(test, tp), 20u + 20u * 5u * 2u - 10u); // all but the 5 with a file, and their parents
+
+        for (int i = 0; i < 20; ++i) {
+            EXPECT_EQ(tuc::fs::exists(test / std::to_string(i)), i % 4 == 0);
+            EXPECT_EQ(tuc::fs::exists(test / std::to_string(i) / "3"), i % 4 == 0);
+            EXPECT_FALSE(tuc::fs::exists(test / std::to_string(i) / "3" / "empty"));
+        }
+
+        for (int i = 0; i < 20; i += 4) {
+            tuc::fs::remove(test / std::to_string(i) / "3" / "test.txt");
+        }
+        EXPECT_EQ(tuc::remove_empty_directories_recursively(test, tp), 11u);
+        EXPECT_FALSE(tuc::fs::exists(test));
+    }
+
+    TEST_F(FilesystemTest, ReportsOrSkipsErrors) {
+        tuc::fs::path missing("filesystem-missing-test-directory");
+        tuc::thread_pool tp(2);
+        EXPECT_EQ(tuc::remove_empty_directories_recursively(missing, tuc::filesystem_error_policy::skip), 0u);
+        EXPECT_EQ(tuc::remove_empty_directories_recursively(missing, tp, tuc::filesystem_error_policy::skip), 0u);
+        try {
+            tuc::remove_empty_directories_recursively(missing, tp);
+            EXPECT_TRUE(false);
+        }
+        catch (tuc::fs::filesystem_error const& e) {
+            EXPECT_EQ(e.path1(), missing);
+        }
+    }
+
+    TEST_F(FilesystemTest, WalksInParallel) {
+        tuc::fs::path test("filesystem-walk-test-directory");
+        for (int i = 0; i < 10; ++i) {
+            tuc::fs::create_directories(test / std::to_string(i) / "sub");
+            std::ofstream(test / std::to_string(i) / "sub" / "test.txt") << "test";
+            std::ofstream(test / std::to_string(i) / "skip.tmp") << "skipped";
+        }
+        tuc::fs::create_directory_symlink(tuc::fs::absolute(test), test / "0" / "loop");
+        tuc::fs::create_directory_symlink(tuc::fs::absolute(test / "2" / "sub"), test / "1" / "link");
+        tuc::fs::create_directory_symlink(tuc::fs::absolute(test / "2" / "sub"), test / "3" / "link");
+        tuc::fs::create_symlink("missing", test / "4" / "broken");
+
+        std::vector<std::string> expected;
+        for (auto i = tuc::fs::recursive_directory_iterator(test); i != tuc::fs::recursive_directory_iterator(); ++i) {
+            expected.push_back(i->path().string());
+        }
+        std::sort(expected.begin(), expected.end());
+        EXPECT_EQ(expected.size(), 10u * 4u + 4u);
+
+        std::vector<std::string> found;
+        tuc::walk(test, tuc::walk_options(), [&found](tuc::walk_entry&& entry) { found.push_back(entry.path.string()); });
+        std::sort(found.begin(), found.end());
+        EXPECT_EQ(found, expected);
+
+        tuc::thread_pool tp(4);
+        std::mutex mutex;
+        found.clear();
+        tuc::walk(test, tp, tuc::walk_options(), [&](tuc::walk_entry&& entry) {
+            std::lock_guard<std::mutex> lock(mutex);
+            found.push_back(entry.path.string());
+        });
+        std::sort(found.begin(), found.end());
+        EXPECT_EQ(found, expected);
+
+        tuc::walk_options options;
+        options.fetch_status = true;
+        options.max_depth = 1;
+        options.exclude = [](tuc::walk_entry const& entry) { return entry.path.extension() == ".tmp"; };
+        options.include = [](tuc::walk_entry const& entry) { return entry.type != tuc::fs::file_type::directory || entry.depth == 1; };
+        tuc::shared_queue<tuc::walk_entry> queue;
+        auto done = tuc::walk(test, tp, options, queue);
+        size_t count = 0;
+        tuc::walk_entry entry;
+        while (done.wait_for(std::chrono::seconds(0)) != std::future_status::ready || !queue.empty()) {
+            if (queue.pop_front(entry, std::chrono::milliseconds(100))) {
+                ++count;
+                EXPECT_NE(entry.path.extension(), ".tmp");
+                EXPECT_TRUE(entry.depth == 1 || entry.type == tuc::fs::file_type::symlink);
+                EXPECT_EQ(entry.last_write_time == tuc::fs::file_time_type::min(), entry.type == tuc::fs::file_type::symlink);
+            }
+        }
+        done.get();
+        EXPECT_EQ(count, 10u + 4u); // the sub directories, and the links
+
+        // The link back to the root is reported, but not followed into the cycle, while both links to
+        // the same sub directory are, and the broken link is reported without an error
+        options = tuc::walk_options();
+        options.follow_symlinks = true;
+        options.fetch_status = true;
+        uintmax_t size = 0;
+        found.clear();
+        tuc::walk(test, tp, options, [&](tuc::walk_entry&& entry) {
+            std::lock_guard<std::mutex> lock(mutex);
+            found.push_back(entry.path.string());
+            size += entry.size;
+        });
+        expected.push_back((test / "1" / "link" / "test.txt").string());
+        expected.push_back((test / "3" / "link" / "test.txt").string());
+        std::sort(expected.begin(), expected.end());
+        std::sort(found.begin(), found.end());
+        EXPECT_EQ(found, expected);
+        EXPECT_EQ(size, 10u * (4u + 7u) + 2u * 4u);
+
+        tuc::fs::remove_all(test);
+    }
+
+    TEST_F(FilesystemTest, ReportsOrSkipsWalkErrors) {
+        tuc::fs::path missing("filesystem-missing-test-directory");
+        tuc::thread_pool tp(2);
+        tuc::walk_options options;
+        options.error_policy = tuc::filesystem_error_policy::skip;
+        size_t count = 0;
+        tuc::walk(missing, tp, options, [&count](tuc::walk_entry&&) { ++count; });
+        EXPECT_EQ(count, 0u);
+        try {
+            tuc::walk(missing, tp, tuc::walk_options(), [](tuc::walk_entry&&) {});
+            EXPECT_TRUE(false);
+        }
+        catch (tuc::fs::filesystem_error const& e) {
+            EXPECT_EQ(e.path1(), missing);
+        }
+    }
+
+    TEST_F(FilesystemTest, ComputesDiskUsageWithCache) {
+        tuc::fs::path test("filesystem-disk-usage-test-directory");
+        for (int i = 0; i < 10; ++i) {
+            tuc::fs::create_directories(test / std::to_string(i) / "sub");
+            std::ofstream(test / std::to_string(i) / "file") << std::string(i, 'x');
+            std::ofstream(test / std::to_string(i) / "sub" / "file") << "abc";
+        }
+        tuc::fs::create_directory_symlink(tuc::fs::absolute(test), test / "0" / "link");
+
+        tuc::disk_usage_info const serial = tuc::disk_usage(test);
+        EXPECT_EQ(serial.size, 45u + 30u);
+        EXPECT_EQ(serial.file_count, 20u);
+        EXPECT_EQ(serial.directory_count, 21u);
+
+        tuc::thread_pool tp(4);
+        tuc::disk_usage_cache cache;
+        tuc::disk_usage_info usage = tuc::disk_usage(test, tp, &cache);
+        EXPECT_EQ(usage.size, serial.size);
+        EXPECT_EQ(usage.file_count, serial.file_count);
+        EXPECT_EQ(usage.directory_count, serial.directory_count);
+        EXPECT_EQ(cache.get_size(), 21u);
+
+        tuc::fs::path const cache_file("filesystem-disk-usage-cache.bin");
+        cache.save(cache_file);
+        tuc::disk_usage_cache loaded;
+        EXPECT_TRUE(loaded.load(cache_file));
+        EXPECT_EQ(loaded.get_size(), 21u);
+
+        // A new file touches the time of its directory, so that is listed again
+        tuc::fs::path const changed = test / "5" / "sub";
+        std::ofstream(changed / "new") << "12345";
+        usage = tuc::disk_usage(test, tp, &loaded);
+        EXPECT_EQ(usage.size, serial.size + 5u);
+        EXPECT_EQ(usage.file_count, serial.file_count + 1u);
+
+        // Whereas files modified in place are not noticed (which shows that the cache is used)
+        std::ofstream(test / "3" / "file", std::ios::app) << "more";
+        EXPECT_EQ(tuc::disk_usage(test, &loaded).size, serial.size + 5u);
+        EXPECT_EQ(tuc::disk_usage(test).size, serial.size + 5u + 4u);
+
+        // A directory whose time is not older than the scan that cached it is listed again, even if
+        // the time has not changed since: here, as if a file had been added within the same tick
+        auto const future = tuc::fs::file_time_type::clock::now() + std::chrono::hours(1);
+        tuc::fs::last_write_time(changed, future);
+        EXPECT_EQ(tuc::disk_usage(test, &loaded).size, serial.size + 5u);
+        std::ofstream(changed / "racy") << "123";
+        tuc::fs::last_write_time(changed, future);
+        EXPECT_EQ(tuc::disk_usage(test, &loaded).size, serial.size + 5u + 3u);
+
+        std::ofstream(cache_file) << "not a cache";
+        EXPECT_FALSE(loaded.load(cache_file));
+        EXPECT_EQ(loaded.get_size(), 0u);
+
+        tuc::fs::remove(cache_file);
+        tuc::fs::remove_all(test);
+    }
+
 }  // namespace
@@ -2,6 +2,8 @@ struct IUnknown; // Workaround for "combaseapi.h(229): error C2187: syntax error
 
 #include "../include/tuc/from_string.hpp"
 #include "picotest/picotest.h"
+#include <cmath>
+#include <string>
 
 namespace {
 
@@ -16,4 +18,69 @@ namespace {
         std::string string = std::to_string(std::numeric_limits<double>::quiet_NaN());
         EXPECT_TRUE(std::isnan(tuc::from_string<double>(string)));
     }
+
+    TEST_F(FromStringTest, ReadsHexadecimalNumbers) {
+        EXPECT_EQ(16.0, tuc::from_string<double>("0x10"));
+        EXPECT_EQ(-3.0f, tuc::from_string<float>(" -0X1.8p1"));
+        EXPECT_EQ(std::optional<double>(0.5), tuc::try_from_string<double>("0x.8"));
+
+        double value = 1.0; // like strtod, reads just the "0" without hexadecimal digits after the "x"
+        auto const result = tuc::from_string("0xg", value);
+        EXPECT_TRUE(result.ec == std::errc());
+        EXPECT_EQ(0.0, value);
+        EXPECT_EQ("xg", std::string_view(result.ptr));
+        EXPECT_FALSE(tuc::try_from_string<double>("0x-1").has_value());
+    }
+
+    TEST_F(FromStringTest, ReadsIntegers) {
+        EXPECT_EQ(-42, tuc::from_string<int>(" -42"));
+        EXPECT_EQ(42u, tuc::from_string<unsigned>("+42"));
+        EXPECT_EQ(18446744073709551615ull, tuc::from_string<unsigned long long>("18446744073709551615"));
+        try {
+            tuc::from_string<unsigned char>("256");
+            EXPECT_TRUE(false);
+        }
+        catch (std::out_of_range const&) {
+        }
+        try {
+            tuc::from_string<int>("x");
+            EXPECT_TRUE(false);
+        }
+        catch (std::invalid_argument const&) {
+        }
+    }
+
+    TEST_F(FromStringTest, ReadsWithoutThrowing) {
+        std::string_view const input = "2.5e3 rest";
+        double value = 0;
+        auto const result = tuc::from_string(input, value);
+        EXPECT_TRUE(result.ec == std::errc());
+        EXPECT_EQ(2500.0, value);
+        EXPECT_EQ(" rest", std::string_view(result.ptr));
+        EXPECT_TRUE(tuc::from_string("+-1", value).ec == std::errc::invalid_argument);
+        EXPECT_TRUE(tuc::from_string("1e999", value).ec == std::errc::result_out_of_range);
+        EXPECT_EQ(2500.0, value);
+
+        EXPECT_EQ(std::optional<float>(1.5f), tuc::try_from_string<float>(" 1.5\n"));
+        EXPECT_FALSE(tuc::try_from_string<float>("1.5x").has_value());
+        EXPECT_FALSE(tuc::try_from_string<int>("").has_value());
+        EXPECT_TRUE(std::isnan(*tuc::try_from_string<double>("-nan")));
+        EXPECT_EQ(-std::numeric_limits<double>::infinity(), *tuc::try_from_string<double>("-Infinity"));
+    }
+
+    TEST_F(FromStringTest, ReadsDelimitedNumbers) {
+        std::vector<double> column;
+        auto const result = tuc::from_delimited_string("1\n-2.5\r\n nan\n", '\n', column);
+        EXPECT_TRUE(result.ec == std::errc());
+        EXPECT_EQ(size_t(3), column.size());
+        EXPECT_EQ(-2.5, column[1]);
+        EXPECT_TRUE(std::isnan(column[2]));
+
+        std::string_view const row = "1, 2,,3";
+        std::vector<int> fields;
+        auto const error = tuc::from_delimited_string(row, ',', fields);
+        EXPECT_TRUE(error.ec == std::errc::invalid_argument);
+        EXPECT_EQ(size_t(5), static_cast<size_t>(error.ptr - row.data()));
+        EXPECT_EQ(std::vector<int>({ 1, 2 }), fields);
+    }
 }  // namespace
@@ -1,6 +1,7 @@
 struct IUnknown; // Workaround for "combaseapi.h(229): error C2187: syntax error: 'identifier' was unexpected here" when using /permissive-
 
 #include "../include/tuc/functional.hpp"
+#include "../include/tuc/thread_pool.hpp"
 #include "picotest/picotest.h"
 #include <iterator>
 #include <deque>
@@ -57,6 +58,98 @@ namespace {
         EXPECT_EQ(output, desired_map_output);
     }
 
+#if TUC_HAS_EXECUTION_POLICY
+    TEST_F(FunctionalTest, MapsInParallel) {
+        std::vector<int> const desired_map_output_as_vector(desired_map_output.begin(), desired_map_output.end());
+
+        auto const output = tuc::map<std::vector<int>>(std::execution::par_unseq, input, map_function);
+        EXPECT_EQ(output, desired_map_output_as_vector);
+
+        auto const default_initialized_output = tuc::map<std::vector<int, tuc::default_init_allocator<int>>>(std::execution::par_unseq, input, map_function);
+        EXPECT_TRUE(std::equal(default_initialized_output.begin(), default_initialized_output.end(), desired_map_output_as_vector.begin(), desired_map_output_as_vector.end()));
+    }
+
+    TEST_F(FunctionalTest, MapsInParallelIntoExistingOutput) {
+        std::vector<int> const desired_map_output_as_vector(desired_map_output.begin(), desired_map_output.end());
+
+        std::vector<int> output(input.size() + 1, -1);
+        auto const end = tuc::map(std::execution::par_unseq, input, output.begin(), map_function);
+
+        EXPECT_EQ(std::distance(output.begin(), end), static_cast<std::ptrdiff_t>(input.size()));
+        EXPECT_TRUE(std::equal(output.begin(), end, desired_map_output_as_vector.begin(), desired_map_output_as_vector.end()));
+        EXPECT_EQ(output.back(), -1);
+    }
+
+    TEST_F(FunctionalTest, MapsInParallelToNonDefaultConstructibleOutput) {
+        struct NonDefaultConstructible {
+            explicit NonDefaultConstructible(int value) : value(std::to_string(value)) {}
+            std::string value;
+        };
+        static_assert(!std::is_default_constructible<NonDefaultConstructible>::value, "");
+
+        auto const output = tuc::map<std::vector<NonDefaultConstructible>>(std::execution::par_unseq, input, [](int value) {
+            return NonDefaultConstructible(2 * value);
+        });
+
+        ASSERT_EQ(output.size(), input.size());
+        for (size_t i = 0; i < input.size(); ++i) {
+            EXPECT_EQ(output[i].value, std::to_string(2 * input[i]));
+        }
+    }
+
+    TEST_F(FunctionalTest, PropagatesExceptionsFromSequentialMap) {
+        static int live_count = 0;
+        struct Counted {
+            explicit Counted(int) { ++live_count; }
+            Counted(Counted const&) { ++live_count; }
+            Counted(Counted&&) { ++live_count; }
+            ~Counted() { --live_count; }
+        };
+        static_assert(!std::is_default_constructible<Counted>::value, "");
+
+        try {
+            tuc::map<std::vector<Counted>>(std::execution::seq, input, [](int value) {
+                if (value == 5) {
+                    throw std::runtime_error("five");
+                }
+                return Counted(value);
+            });
+            EXPECT_TRUE(false);
+        }
+        catch (std::runtime_error&) {
+            ; // this is where we want to be
+        }
+        EXPECT_EQ(live_count, 0);
+
+        try {
+            tuc::map<std::vector<int>>(std::execution::seq, input, [](int value) {
+                if (value == 5) {
+                    throw std::runtime_error("five");
+                }
+                return value;
+            });
+            EXPECT_TRUE(false);
+        }
+        catch (std::runtime_error&) {
+            ; // this is where we want to be
+        }
+
+        std::vector<int> output(input.size());
+        try {
+            tuc::map(std::execution::seq, input, output.begin(), [](int value) {
+                if (value == 5) {
+                    throw std::runtime_error("five");
+                }
+                return value;
+            });
+            EXPECT_TRUE(false);
+        }
+        catch (std::runtime_error&) {
+            ; // this is where we want to be
+        }
+    }
+#endif // TUC_HAS_EXECUTION_POLICY
+
     TEST_F(FunctionalTest, FiltersVector) {
         std::vector<int> const desired_filter_output_as_vector(desired_filter_output.begin(), desired_filter_output.end());
 
@@ -168,17 +261,204 @@ namespace {
         EXPECT_EQ(*minmax_element.second, 3);
     }
 
+    TEST_F(FunctionalTest, EvaluatesProjectionOncePerElementWhenFindingMinMaxElement) {
+        std::vector<int> const values { 3, 1, 4, 1, 5, 9, 2, 6, 5, 3 };
+        size_t evaluations = 0;
+        auto const counting_identity = [&evaluations](int value) { ++evaluations; return value; };
+        auto const minmax_element = tuc::minmax_element(values, counting_identity);
+        EXPECT_EQ(evaluations, values.size());
+        EXPECT_EQ(std::distance(values.begin(), minmax_element.first), 1);  // the first smallest
+        EXPECT_EQ(std::distance(values.begin(), minmax_element.second), 5);
+    }
+
+#if TUC_HAS_EXECUTION_POLICY
+    TEST_F(FunctionalTest, FindsMinMaxElementInParallel) {
+        std::vector<std::pair<int, double>> values(100000);
+        {
+            std::mt19937 generator(42);
+            std::uniform_real_distribution<double> distribution(-1000.0, 1000.0);
+            for (size_t i = 0; i < values.size(); ++i) {
+                values[i] = { static_cast<int>(i), distribution(generator) };
+            }
+        }
+        auto const second = [](auto const& value) { return value.second; };
+        auto const second_as_string = [](auto const& value) { return std::to_string(value.second); };
+        auto const parallel = std::execution::par_unseq;
+
+        EXPECT_EQ(tuc::min_element(parallel, values, second), tuc::min_element(values, second));
+        EXPECT_EQ(tuc::max_element(parallel, values, second), tuc::max_element(values, second));
+        EXPECT_EQ(tuc::minmax_element(parallel, values, second), tuc::minmax_element(values, second));
+
+        EXPECT_EQ(tuc::min_element(parallel, values, second_as_string), tuc::min_element(values, second_as_string));
+        EXPECT_EQ(tuc::max_element(parallel, values, second_as_string), tuc::max_element(values, second_as_string));
+
+        std::vector<std::pair<int, double>> const empty;
+        EXPECT_EQ(tuc::min_element(parallel, empty, second), empty.end());
+    }
+#endif // TUC_HAS_EXECUTION_POLICY
+
     TEST_F(FunctionalTest, EvaluatesLazily) {
         int counter = 0;
         auto const function = [&]() {
             return ++counter;
         };
         tuc::lazy_evaluator<int> const evaluator(function);
+        static_assert(!std::is_move_constructible<tuc::lazy_evaluator<int>>::value, "the result is kept inside");
+        EXPECT_EQ(evaluator.get_result(), 1);
+        EXPECT_EQ(evaluator.get_result(), 1);
+        EXPECT_EQ(counter, 1);
+    }
+
+    TEST_F(FunctionalTest, EvaluatesLazilyFromSeveralThreads) {
+        std::atomic<int> counter{ 0 };
+        auto const function = [&]() {
+            std::this_thread::sleep_for(std::chrono::milliseconds(10));
+            return std::vector<int>(1000, ++counter);
+        };
+        tuc::lazy_evaluator const evaluator(function);
+
+        std::vector<std::thread> threads;
+        std::vector<int> results(8);
+        for (size_t i = 0; i < results.size(); ++i) {
+            threads.emplace_back([&, i]() { results[i] = evaluator.get_result().back(); });
+        }
+        for (auto& thread : threads) {
+            thread.join();
+        }
+
+        EXPECT_EQ(counter, 1);
+        EXPECT_EQ(results, std::vector<int>(results.size(), 1));
+    }
+
+    TEST_F(FunctionalTest, EvaluatesInBackground) {
+        std::atomic<int> counter{ 0 };
+        auto const function = [&]() {
+            return ++counter;
+        };
+        tuc::thread_pool tp(1);
+        tuc::lazy_evaluator const evaluator(function, tp);
+
+        while (counter == 0) {
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        }
+
         EXPECT_EQ(evaluator.get_result(), 1);
         EXPECT_EQ(evaluator.get_result(), 1);
         EXPECT_EQ(counter, 1);
     }
 
+    TEST_F(FunctionalTest, Memoizes) {
+        std::atomic<int> evaluations{ 0 };
+        tuc::memoize<std::string, int, std::string> memoized([&](int n, std::string const& s) {
+            ++evaluations;
+            std::string result;
+            for (int i = 0; i < n; ++i) {
+                result += s;
+            }
+            return result;
+        }, 2, 1);
+
+        EXPECT_EQ(memoized(3, "ab"), "ababab");
+        EXPECT_EQ(memoized(3, "ab"), "ababab");
+        EXPECT_EQ(evaluations, 1);
+        EXPECT_EQ(memoized(2, "c"), "cc");
+        EXPECT_EQ(memoized(3, "ab"), "ababab");
+        EXPECT_EQ(evaluations, 2);
+
+        EXPECT_EQ(memoized(1, "d"), "d"); // evicts (2, "c"), the least recently used
+        EXPECT_EQ(memoized(3, "ab"), "ababab");
+        EXPECT_EQ(evaluations, 3);
+        EXPECT_EQ(memoized(2, "c"), "cc");
+        EXPECT_EQ(evaluations, 4);
+
+        EXPECT_EQ(memoized.get_hit_count(), 3u);
+        EXPECT_EQ(memoized.get_miss_count(), 4u);
+    }
+
+    TEST_F(FunctionalTest, BoundsMemoizedSizeByCapacity) {
+        tuc::memoize<int, int> memoized([](int n) { return 2 * n; }, 10); // with more shards by default
+        for (int n = 0; n < 100; ++n) {
+            EXPECT_EQ(memoized(n), 2 * n);
+        }
+        for (int n = 99; n >= 0; --n) { // the most recently used first, so that all that are kept hit
+            EXPECT_EQ(memoized(n), 2 * n);
+        }
+        EXPECT_TRUE(memoized.get_hit_count() <= 10u);
+        EXPECT_EQ(memoized.get_hit_count() + memoized.get_miss_count(), 200u);
+    }
+
+    TEST_F(FunctionalTest, MemoizesConcurrently) {
+        std::atomic<int> evaluations{ 0 };
+        tuc::memoize<int, int> memoized([&](int n) {
+            ++evaluations;
+            std::this_thread::sleep_for(std::chrono::milliseconds(10));
+            if (n < 0) {
+                throw std::runtime_error("negative");
+            }
+            return 2 * n;
+        });
+
+        std::vector<std::thread> threads;
+        std::vector<int> results(8);
+        for (size_t i = 0; i < results.size(); ++i) {
+            threads.emplace_back([&, i]() { results[i] = memoized(21); });
+        }
+        for (auto& thread : threads) {
+            thread.join();
+        }
+
+        EXPECT_EQ(evaluations, 1);
+        EXPECT_EQ(results, std::vector<int>(results.size(), 42));
+        EXPECT_EQ(memoized.get_miss_count(), 1u);
+        EXPECT_EQ(memoized.get_hit_count(), results.size() - 1);
+
+        for (int attempt = 0; attempt < 2; ++attempt) {
+            try {
+                memoized(-1);
+                EXPECT_TRUE(false);
+            }
+            catch (std::runtime_error&) {
+                ; // this is where we want to be
+            }
+        }
+        EXPECT_EQ(evaluations, 3); // failures are not cached
+    }
+
+    TEST_F(FunctionalTest, KeepsNewerEntryWhenEvictedEvaluationFails) {
+        std::atomic<int> evaluations{ 0 };
+        std::atomic<bool> started{ false };
+        std::promise<void> release;
+        std::shared_future<void> const released = release.get_future().share();
+        tuc::memoize<int, int> memoized([&](int n) {
+            if (++evaluations == 1) {
+                started = true;
+                released.wait();
+                throw std::runtime_error("first");
+            }
+            return 2 * n;
+        }, 1, 1);
+
+        std::thread failing([&]() {
+            try {
+                memoized(1);
+                EXPECT_TRUE(false);
+            }
+            catch (std::runtime_error&) {
+                ; // this is where we want to be
+            }
+        });
+        while (!started) {
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        }
+        EXPECT_EQ(memoized(2), 4); // evicts the failing entry
+        EXPECT_EQ(memoized(1), 2); // and this one evicts 2
+        release.set_value();
+        failing.join();
+
+        EXPECT_EQ(memoized(1), 2);
+        EXPECT_EQ(evaluations, 3); // the failure did not drop the newer entry
+    }
+
     TEST_F(FunctionalTest, AppliesFunctionWithoutUnnecessaryCopyingData) {
         class Noncopyable {
         public:
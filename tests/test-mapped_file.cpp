@@ -0,0 +1,89 @@
+struct IUnknown; // Workaround for "combaseapi.h(229): error C2187: syntax error: 'identifier' was unexpected here" when using /permissive-
+
+#include "../include/tuc/mapped_file.hpp"
+#include "../include/tuc/thread_pool.hpp"
+#include "picotest/picotest.h"
+#include <fstream>
+#include <numeric>
+#include <string>
+#include <vector>
+
+namespace {
+
+    class MappedFileTest : public ::testing::Test {
+    };
+
+    TEST_F(MappedFileTest, IteratesLines) {
+        tuc::fs::path const path("mapped-file-test.txt");
+        std::ofstream(path, std::ios::binary) << "first\r\nsecond\n\nlast";
+
+        tuc::mapped_file file(path, tuc::access_hint::sequential);
+        EXPECT_EQ(file.size(), 19u);
+        EXPECT_EQ(file.get_view().substr(0, 5), "first");
+
+        std::vector<std::string> lines(file.get_lines().begin(), file.get_lines().end());
+        EXPECT_EQ(lines, std::vector<std::string>({ "first", "second", "", "last" }));
+        lines.assign(tuc::line_range("a\n").begin(), tuc::line_range("a\n").end());
+        EXPECT_EQ(lines, std::vector<std::string>({ "a" }));
+        EXPECT_TRUE(tuc::line_range("").begin() == tuc::line_range("").end());
+
+        tuc::mapped_file moved(std::move(file));
+        EXPECT_TRUE(file.empty());
+        EXPECT_EQ(moved.size(), 19u);
+        moved.close();
+        tuc::fs::remove(path);
+
+        std::ofstream(path).close();
+        EXPECT_TRUE(tuc::mapped_file(path).empty());
+        tuc::fs::remove(path);
+
+        try {
+            tuc::mapped_file missing(path);
+            EXPECT_TRUE(false);
+        }
+        catch (tuc::fs::filesystem_error const& e) {
+            EXPECT_EQ(e.path1(), path);
+        }
+    }
+
+    TEST_F(MappedFileTest, ParsesChunksInParallel) {
+        tuc::fs::path const path("mapped-file-chunk-test.txt");
+        {
+            std::ofstream out(path);
+            for (int i = 1; i <= 1000; ++i) {
+                out << i << "\n";
+            }
+        }
+
+        tuc::mapped_file const file(path);
+        auto const chunks = file.get_chunks(7);
+        EXPECT_EQ(chunks.size(), 7u);
+        size_t total_size = 0;
+        for (auto const& chunk : chunks) {
+            EXPECT_EQ(chunk.back(), '\n');
+            total_size += chunk.size();
+        }
+        EXPECT_EQ(total_size, file.size());
+
+        tuc::thread_pool tp(4);
+        auto const sum_lines = [](std::string_view chunk) {
+            long sum = 0;
+            for (auto const line : tuc::line_range(chunk)) {
+                sum += std::stol(std::string(line));
+            }
+            return sum;
+        };
+        long sum = 0;
+        for (auto& future : tp.launch_in_chunks(sum_lines, chunks, 1)) {
+            sum += future.get();
+        }
+        EXPECT_EQ(sum, 1000l * 1001l / 2);
+
+        EXPECT_EQ(tuc::split_into_line_chunks("a\nb", 5).size(), 2u);
+        EXPECT_EQ(tuc::split_into_line_chunks("long line", 3).size(), 1u);
+        EXPECT_TRUE(tuc::split_into_line_chunks("", 3).empty());
+
+        tuc::fs::remove(path);
+    }
+
+}  // namespace
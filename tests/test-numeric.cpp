@@ -2,6 +2,11 @@ struct IUnknown; // Workaround for "combaseapi.h(229): error C2187: syntax error
 
 #include "../include/tuc/numeric.hpp"
 #include "picotest/picotest.h"
+#include <cstring> // memcmp
+#include <random>
+#include <deque>
+#include <thread>
+#include <vector>
 
 namespace {
 
@@ -30,6 +35,87 @@ namespace {
         EXPECT_EQ(0, tuc::divide_rounding_down(0, 2));
     }
 
+    template <typename T>
+    void expect_same_results_as_plain_division(T denominator, std::vector<T> const& numerators) {
+        tuc::divider<T> const divider(denominator);
+        for (T const numerator : numerators) {
+            EXPECT_EQ(divider.divide(numerator), static_cast<T>(numerator / denominator));
+            EXPECT_EQ(divider.divide_rounding_up(numerator), tuc::divide_rounding_up(numerator, denominator));
+            EXPECT_EQ(divider.divide_rounding_down(numerator), tuc::divide_rounding_down(numerator, denominator));
+            EXPECT_EQ(divider.divide_rounding_to_closest(numerator), tuc::divide_rounding_to_closest(numerator, denominator));
+        }
+    }
+
+    template <typename T>
+    void test_divider() {
+        std::mt19937_64 generator(42);
+        auto const random = [&generator]() {
+            T value;
+            auto const bits = generator();
+            std::memcpy(&value, &bits, sizeof(value));
+            return value;
+        };
+
+        // avoid the values for which the plain division functions overflow
+        auto const is_safe = [](T value) {
+            return value > std::numeric_limits<T>::lowest() / 2 && value < (std::numeric_limits<T>::max)() / 2;
+        };
+
+        std::vector<T> numerators = { 0, 1, 2, 3, 7, 100 };
+        if (std::is_signed<T>::value) {
+            for (T const n : std::vector<T>(numerators)) {
+                numerators.push_back(static_cast<T>(-n));
+            }
+        }
+        while (numerators.size() < 200) {
+            T const numerator = random();
+            if (is_safe(numerator)) {
+                numerators.push_back(numerator);
+            }
+        }
+
+        std::vector<T> denominators = { 1, 2, 3, 7, 10, 64, 100, static_cast<T>((std::numeric_limits<T>::max)() / 3) };
+        if (std::is_unsigned<T>::value) {
+            denominators.push_back((std::numeric_limits<T>::max)());
+        }
+        if (std::is_signed<T>::value) {
+            for (T const d : std::vector<T>(denominators)) {
+                denominators.push_back(static_cast<T>(-d));
+            }
+        }
+        while (denominators.size() < 100) {
+            T const denominator = random() >> (generator() % (8 * sizeof(T)));
+            if (denominator != 0 && (std::is_unsigned<T>::value || is_safe(denominator))) {
+                denominators.push_back(denominator);
+            }
+        }
+
+        for (T const denominator : denominators) {
+            expect_same_results_as_plain_division(denominator, numerators);
+        }
+    }
+
+    TEST_F(NumericTest, DividesUsingPrecomputedReciprocal) {
+        test_divider<int8_t>();
+        test_divider<uint8_t>();
+        test_divider<int16_t>();
+        test_divider<uint16_t>();
+        test_divider<int32_t>();
+        test_divider<uint32_t>();
+        test_divider<int64_t>();
+        test_divider<uint64_t>();
+
+        std::vector<int> const numerators = { -5, 0, 5, 7, 8 };
+        std::vector<int> output(numerators.size());
+        tuc::divider<int> const divider(3);
+        divider.divide_rounding_to_closest(numerators.data(), numerators.data() + numerators.size(), output.data());
+        EXPECT_EQ(output, std::vector<int>({ -2, 0, 2, 2, 3 }));
+        divider.divide_rounding_up(numerators.data(), numerators.data() + numerators.size(), output.data());
+        EXPECT_EQ(output, std::vector<int>({ -1, 0, 2, 3, 3 }));
+        divider.divide_rounding_down(numerators.data(), numerators.data() + numerators.size(), output.data());
+        EXPECT_EQ(output, std::vector<int>({ -2, 0, 1, 2, 2 }));
+    }
+
     TEST_F(NumericTest, RoundsEasily) {
         EXPECT_EQ(3, tuc::round(3.1));
         EXPECT_EQ(3u, tuc::round<unsigned int>(3.1));
@@ -64,6 +150,95 @@ namespace {
         expect_overflow<unsigned int>(-5.0);
     }
 
+    template <typename Output>
+    void test_batch_round(std::vector<float> const& input) {
+        std::vector<Output> expected(input.size()), actual(input.size());
+        size_t first_overflow = input.size();
+        for (size_t i = 0; i < input.size(); ++i) {
+            float const rounded = std::round(input[i]);
+            if (std::isnan(rounded)) {
+                expected[i] = 0;
+            }
+            else if (rounded < static_cast<double>(std::numeric_limits<Output>::lowest())) {
+                expected[i] = std::numeric_limits<Output>::lowest();
+            }
+            else if (rounded > static_cast<double>((std::numeric_limits<Output>::max)())) {
+                expected[i] = (std::numeric_limits<Output>::max)();
+            }
+            else {
+                expected[i] = static_cast<Output>(rounded);
+                continue;
+            }
+            first_overflow = (std::min)(first_overflow, i);
+        }
+
+        float const* const begin = input.data();
+        float const* const end = input.data() + input.size();
+
+        EXPECT_EQ(tuc::round(begin, end, actual.data(), tuc::overflow_policy::saturate), input.size());
+        EXPECT_EQ(actual, expected);
+
+        std::fill(actual.begin(), actual.end(), Output(0));
+        EXPECT_EQ(tuc::round(begin, end, actual.data(), tuc::overflow_policy::stop), first_overflow);
+        EXPECT_TRUE(std::equal(actual.begin(), actual.begin() + first_overflow, expected.begin()));
+
+        try {
+            tuc::round(begin, end, actual.data());
+            EXPECT_EQ(first_overflow, input.size());
+        }
+        catch (std::exception&) {
+            EXPECT_LT(first_overflow, input.size());
+        }
+    }
+
+    TEST_F(NumericTest, RoundsBatches) {
+        std::vector<float> input;
+        std::mt19937 generator(42);
+        std::uniform_real_distribution<float> distribution(-3.f, 300.f);
+        while (input.size() < 1003) {
+            input.push_back(std::round(distribution(generator) * 2.f) / 2.f); // plenty of ties
+        }
+
+        auto& selected_instruction_set = tuc::simd_detail::selected_instruction_set();
+        auto const original_instruction_set = selected_instruction_set;
+
+        for (auto const instruction_set : { tuc::simd_detail::instruction_set::scalar, tuc::simd_detail::instruction_set::sse2, tuc::simd_detail::instruction_set::avx2, tuc::simd_detail::instruction_set::neon }) {
+            if (!tuc::simd_detail::is_supported(instruction_set)) {
+                continue;
+            }
+            selected_instruction_set = instruction_set;
+
+            // No overflows for these
+            test_batch_round<int32_t>(input);
+            test_batch_round<int16_t>(input);
+
+            std::vector<float> extremes = input;
+            extremes[500] = std::numeric_limits<float>::quiet_NaN();
+            extremes[600] = 2147483648.f;
+            extremes[601] = -2147483648.f;
+            extremes[602] = -2147483904.f;
+            extremes[603] = std::numeric_limits<float>::infinity();
+            extremes[604] = 65535.49f;
+            extremes[605] = 65535.5f;
+            extremes[606] = -32768.5f;
+            extremes[607] = 8388609.f;
+            extremes[608] = -0.5f;
+            test_batch_round<int32_t>(extremes);
+            test_batch_round<int16_t>(extremes);
+            test_batch_round<uint16_t>(extremes);
+            test_batch_round<uint8_t>(extremes);
+            test_batch_round<int8_t>(extremes); // not vectorized
+            test_batch_round<int64_t>(extremes);
+        }
+
+        selected_instruction_set = original_instruction_set;
+
+        std::vector<double> const doubles = { 0.5, -0.5, 1.5, 1e20 };
+        std::vector<int> rounded(doubles.size());
+        EXPECT_EQ(tuc::round(doubles.data(), doubles.data() + doubles.size(), rounded.data(), tuc::overflow_policy::stop), 3u);
+        EXPECT_EQ(rounded, std::vector<int>({ 1, -1, 2, 0 }));
+    }
+
     TEST_F(NumericTest, InterpolatesLinearly) {
         EXPECT_EQ(tuc::lerp(2.0, 5.0, 0.0), 2.0);
         EXPECT_EQ(tuc::lerp(2.0, 5.0, 1.0), 5.0);
@@ -72,6 +247,74 @@ namespace {
         EXPECT_EQ(tuc::lerp(2.0, 5.0, 2.0), 8.0);
     }
 
+    TEST_F(NumericTest, ProcessesBatchesIdenticallyToScalars) {
+        std::vector<float> input = {
+            -0.f, 0.f, 1.f, -1.f, 0.5f, 2.f, 3.f,
+            std::numeric_limits<float>::quiet_NaN(),
+            std::numeric_limits<float>::infinity(),
+            -std::numeric_limits<float>::infinity(),
+            std::numeric_limits<float>::denorm_min(),
+        };
+        {
+            std::mt19937 generator(42);
+            std::uniform_real_distribution<float> distribution(-2.f, 4.f);
+            while (input.size() < 1003) { // not divisible by any vector width, so there's a tail to process
+                input.push_back(distribution(generator));
+            }
+        }
+        std::vector<float> input2(input.rbegin(), input.rend());
+
+        auto const bitwise_equal = [](std::vector<float> const& lhs, std::vector<float> const& rhs) {
+            return lhs.size() == rhs.size() && std::memcmp(lhs.data(), rhs.data(), lhs.size() * sizeof(float)) == 0;
+        };
+
+        auto& selected_instruction_set = tuc::simd_detail::selected_instruction_set();
+        auto const original_instruction_set = selected_instruction_set;
+
+        for (auto const instruction_set : { tuc::simd_detail::instruction_set::scalar, tuc::simd_detail::instruction_set::sse2, tuc::simd_detail::instruction_set::avx2, tuc::simd_detail::instruction_set::neon }) {
+            if (!tuc::simd_detail::is_supported(instruction_set)) {
+                continue;
+            }
+            selected_instruction_set = instruction_set;
+
+            std::vector<float> expected(input.size()), actual(input.size());
+            float const* const begin = input.data();
+            float const* const end = input.data() + input.size();
+
+            for (size_t i = 0; i < input.size(); ++i) {
+                expected[i] = tuc::lerp(input[i], input2[i], 0.3);
+            }
+            tuc::lerp(begin, end, input2.data(), actual.data(), 0.3);
+            EXPECT_TRUE(bitwise_equal(expected, actual));
+
+            for (size_t i = 0; i < input.size(); ++i) {
+                expected[i] = tuc::clamp(input[i], 0.25f, 1.5f);
+            }
+            tuc::clamp(begin, end, actual.data(), 0.25f, 1.5f);
+            EXPECT_TRUE(bitwise_equal(expected, actual));
+
+            for (size_t i = 0; i < input.size(); ++i) {
+                expected[i] = tuc::smoothstep(-0.5f, 1.7f, input[i]);
+            }
+            tuc::smoothstep(-0.5f, 1.7f, begin, end, actual.data());
+            EXPECT_TRUE(bitwise_equal(expected, actual));
+
+            for (size_t i = 0; i < input.size(); ++i) {
+                expected[i] = tuc::smootherstep(-0.5f, 1.7f, input[i]);
+            }
+            actual = input;
+            tuc::smootherstep(-0.5f, 1.7f, actual.data(), actual.data() + actual.size(), actual.data()); // in place
+            EXPECT_TRUE(bitwise_equal(expected, actual));
+        }
+
+        selected_instruction_set = original_instruction_set;
+
+        std::vector<double> const doubles = { -1.0, 0.5, 2.0 };
+        std::vector<double> clamped(doubles.size());
+        tuc::clamp(doubles.data(), doubles.data() + doubles.size(), clamped.data(), 0.0, 1.0);
+        EXPECT_EQ(clamped, std::vector<double>({ 0.0, 0.5, 1.0 }));
+    }
+
     TEST(NumericTest, DeterminesSign) {
         EXPECT_EQ(tuc::sign(2), 1);
         EXPECT_EQ(tuc::sign(1), 1);
@@ -101,6 +344,177 @@ namespace {
         }
     }
 
+    TEST_F(NumericTest, CalculatesMeansRobustly) {
+        std::vector<double> const large(10000, 1e10);
+        std::vector<double> const small(10000, 1e-10);
+        EXPECT_NEAR(tuc::geometric_mean(large.begin(), large.end()), 1e10, 1e-3);
+        EXPECT_NEAR(tuc::geometric_mean(small.begin(), small.end()), 1e-10, 1e-23);
+        EXPECT_NEAR(tuc::power_mean(large.begin(), large.end(), 0), 1e10, 1e-3);
+
+        // 0.1 is not exactly representable, so naive summation accumulates the rounding errors
+        std::vector<double> const tenths(1000000, 0.1);
+        EXPECT_EQ(tuc::arithmetic_mean(tenths.begin(), tenths.end()), 0.1);
+        std::vector<float> const float_tenths(tenths.begin(), tenths.end());
+        EXPECT_EQ(tuc::arithmetic_mean(float_tenths.begin(), float_tenths.end()), static_cast<double>(0.1f));
+        std::deque<double> const tenths_in_deque(tenths.begin(), tenths.end());
+        EXPECT_EQ(tuc::arithmetic_mean(tenths_in_deque.begin(), tenths_in_deque.end()), 0.1);
+    }
+
+#if TUC_HAS_EXECUTION_POLICY
+    TEST_F(NumericTest, CalculatesMeansInParallel) {
+        std::vector<double> numbers(1000000);
+        {
+            std::mt19937 generator(42);
+            std::uniform_real_distribution<double> distribution(0.5, 2.0);
+            std::generate(numbers.begin(), numbers.end(), [&]() { return distribution(generator); });
+        }
+        auto const parallel = std::execution::par_unseq;
+        EXPECT_NEAR(tuc::arithmetic_mean(parallel, numbers.begin(), numbers.end()), tuc::arithmetic_mean(numbers.begin(), numbers.end()), 1e-14);
+        EXPECT_NEAR(tuc::geometric_mean(parallel, numbers.begin(), numbers.end()), tuc::geometric_mean(numbers.begin(), numbers.end()), 1e-12);
+        for (double const p : { -2.0, -1.0, 0.0, 0.5, 1.0, 2.0, 3.7 }) {
+            EXPECT_NEAR(tuc::power_mean(parallel, numbers.begin(), numbers.end(), p), tuc::power_mean(numbers.begin(), numbers.end(), p), 1e-12);
+        }
+        EXPECT_EQ(tuc::power_mean(parallel, numbers.begin(), numbers.end(), std::numeric_limits<double>::infinity()), *std::max_element(numbers.begin(), numbers.end()));
+    }
+#endif // TUC_HAS_EXECUTION_POLICY
+
+    TEST_F(NumericTest, CalculatesRunningStatistics) {
+        std::vector<double> numbers(1001);
+        {
+            std::mt19937 generator(42);
+            std::normal_distribution<double> distribution(5.0, 2.0);
+            std::generate(numbers.begin(), numbers.end(), [&]() { return distribution(generator); });
+        }
+
+        tuc::running_statistics<> all, first_half, second_half;
+        for (size_t i = 0; i < numbers.size(); ++i) {
+            all.add(numbers[i]);
+            (i < numbers.size() / 2 ? first_half : second_half).add(numbers[i]);
+        }
+
+        double const mean = tuc::arithmetic_mean(numbers.begin(), numbers.end());
+        double sum_of_squared_deviations = 0;
+        for (double const number : numbers) {
+            sum_of_squared_deviations += (number - mean) * (number - mean);
+        }
+
+        EXPECT_EQ(all.get_count(), numbers.size());
+        EXPECT_NEAR(all.get_mean(), mean, 1e-12);
+        EXPECT_NEAR(all.get_variance(), sum_of_squared_deviations / numbers.size(), 1e-12);
+        EXPECT_NEAR(all.get_sample_variance(), sum_of_squared_deviations / (numbers.size() - 1), 1e-12);
+        EXPECT_EQ(all.get_min(), *std::min_element(numbers.begin(), numbers.end()));
+        EXPECT_EQ(all.get_max(), *std::max_element(numbers.begin(), numbers.end()));
+
+        tuc::running_statistics<> merged;
+        merged += first_half;
+        merged += second_half;
+        EXPECT_EQ(merged.get_count(), all.get_count());
+        EXPECT_NEAR(merged.get_mean(), all.get_mean(), 1e-12);
+        EXPECT_NEAR(merged.get_variance(), all.get_variance(), 1e-12);
+        EXPECT_EQ(merged.get_min(), all.get_min());
+        EXPECT_EQ(merged.get_max(), all.get_max());
+    }
+
+    TEST_F(NumericTest, CalculatesRunningPowerMeans) {
+        std::vector<double> const numbers = { 1.0, 3.0, 9.0 };
+        for (double const p : { -std::numeric_limits<double>::infinity(), -1.0, 0.0, 1.0, 2.0, 300.0, std::numeric_limits<double>::infinity() }) {
+            tuc::running_power_mean<> all(p), first(p), rest(p);
+            for (size_t i = 0; i < numbers.size(); ++i) {
+                all.add(numbers[i]);
+                (i == 0 ? first : rest).add(numbers[i]);
+            }
+            first += rest;
+            double const expected = tuc::power_mean(numbers.begin(), numbers.end(), p);
+            EXPECT_NEAR(all.get(), expected, 1e-12);
+            EXPECT_NEAR(first.get(), expected, 1e-12);
+            EXPECT_EQ(first.get_count(), numbers.size());
+        }
+    }
+
+    TEST_F(NumericTest, EstimatesQuantiles) {
+        std::mt19937 generator(42);
+        std::exponential_distribution<double> distribution(1e-4); // mean 10000
+        std::vector<double> values(100000);
+        for (double& value : values) {
+            value = distribution(generator);
+        }
+
+        tuc::log_histogram histogram(100000000), first_histogram(1000000), second_histogram(100000000);
+        tuc::quantile_digest<> digest, first_digest, second_digest;
+        for (size_t i = 0; i < values.size(); ++i) {
+            auto const value = static_cast<uint64_t>(values[i]);
+            histogram.add(value);
+            digest.add(values[i]);
+            (i % 2 ? first_histogram : second_histogram).add(value);
+            (i % 2 ? first_digest : second_digest).add(values[i]);
+        }
+        first_histogram += second_histogram;
+        first_digest += second_digest;
+
+        std::sort(values.begin(), values.end());
+        for (double const q : { 0.0, 0.001, 0.01, 0.1, 0.5, 0.9, 0.99, 0.999, 1.0 }) {
+            double const expected = values[std::min(static_cast<size_t>(q * values.size()), values.size() - 1)];
+            EXPECT_NEAR(static_cast<double>(histogram.get_quantile(q)), std::floor(expected), 1 + expected * 1e-3);
+            EXPECT_EQ(first_histogram.get_quantile(q), histogram.get_quantile(q));
+            // The t-digest gives no hard guarantees, so check just that the rank of the estimate is about right
+            auto const get_rank = [&values](double value) {
+                return static_cast<double>(std::lower_bound(values.begin(), values.end(), value) - values.begin()) / values.size();
+            };
+            EXPECT_NEAR(get_rank(digest.get_quantile(q)), q, 2e-3);
+            EXPECT_NEAR(get_rank(first_digest.get_quantile(q)), q, 2e-3);
+        }
+
+        EXPECT_EQ(histogram.get_count(), values.size());
+        EXPECT_EQ(first_digest.get_count(), values.size());
+        EXPECT_EQ(digest.get_min(), values.front());
+        EXPECT_EQ(digest.get_max(), values.back());
+        EXPECT_EQ(tuc::log_histogram(100).get_quantile(0.5), 0u);
+        EXPECT_TRUE(std::isnan(tuc::quantile_digest<>().get_quantile(0.5)));
+    }
+
+    TEST(NumericTest, MergesLargeDigestIntoSmallOne) {
+        tuc::quantile_digest<> small(10), large(10);
+        for (int i = 0; i < 49; ++i) { // just buffered
+            small.add(i / 49.0);
+        }
+        for (int i = 0; i < 100000; ++i) {
+            large.add(i / 100000.0);
+        }
+        small += large;
+
+        EXPECT_EQ(small.get_count(), 100049u);
+        EXPECT_LE(small.get_centroid_count(), 10u);
+        for (double const q : { 0.01, 0.1, 0.5, 0.9, 0.99 }) {
+            EXPECT_NEAR(small.get_quantile(q), q, 0.02);
+        }
+
+        small += small;
+        EXPECT_EQ(small.get_count(), 2 * 100049u);
+        EXPECT_NEAR(small.get_quantile(0.5), 0.5, 0.02);
+    }
+
+    TEST(NumericTest, ReadsAndMergesDigestsFromSeveralThreads) {
+        tuc::quantile_digest<> source(10), first(10), second(10);
+        for (int i = 0; i < 1000; ++i) {
+            source.add(i); // leaves some values buffered
+        }
+        std::vector<double> medians(4);
+        std::vector<std::thread> threads;
+        for (size_t i = 0; i < medians.size(); ++i) {
+            threads.emplace_back([&, i]() { medians[i] = source.get_quantile(0.5); });
+        }
+        threads.emplace_back([&]() { first += source; });
+        threads.emplace_back([&]() { second += source; });
+        for (auto& thread : threads) {
+            thread.join();
+        }
+        for (double const median : medians) {
+            EXPECT_NEAR(median, 500, 20);
+        }
+        EXPECT_EQ(first.get_count(), 1000u);
+        EXPECT_EQ(second.get_quantile(0.5), first.get_quantile(0.5));
+    }
+
     TEST(NumericTest, ProvidesUnambiguousClampFunctionality) {
         EXPECT_EQ(tuc::unambiguous_clamp<int>().low(5).high(10).value(3), 5);
         EXPECT_EQ(tuc::unambiguous_clamp<int>().low(5).high(10).value(12), 10);
@@ -2,6 +2,8 @@ struct IUnknown; // Workaround for "combaseapi.h(229): error C2187: syntax error
 
 #include "../include/tuc/string.hpp"
 #include "picotest/picotest.h"
+#include <unordered_map>
+#include <random>
 
 namespace {
 
@@ -18,6 +20,26 @@ namespace {
         EXPECT_EQ("abc", tuc::string::right("abc", 4));
     }
 
+    TEST_F(StringTest, ReturnsViewsWithoutCopying) {
+        std::string const input = "abcdef";
+        auto const left = tuc::string::left(input, 2);
+        auto const right = tuc::string::right(input, 2);
+        static_assert(std::is_same<decltype(left), std::string_view const>::value, "a view expected");
+        EXPECT_EQ(left.data(), input.data());
+        EXPECT_EQ(right.data(), input.data() + 4);
+        EXPECT_EQ(tuc::generic_string::left(std::wstring_view(L"abc"), 2), L"ab");
+
+        // Views into temporaries would dangle, so strings are returned instead
+        auto const temporary_right = tuc::string::right(std::string("abcdef"), 2);
+        static_assert(std::is_same<decltype(temporary_right), std::string const>::value, "a string expected");
+        EXPECT_EQ(temporary_right, "ef");
+        EXPECT_EQ(tuc::wstring::left(std::wstring(L"abc"), 2), L"ab");
+
+        EXPECT_TRUE(tuc::generic_string::starts_with(input, std::string_view("abc")));
+        EXPECT_TRUE(tuc::generic_string::ends_with(std::wstring(L"abc"), L"bc"));
+        EXPECT_TRUE(tuc::generic_string::equal_case_insensitive(input, "ABCDEF"));
+    }
+
     TEST_F(StringTest, TellsIfStartsWith) {
         EXPECT_TRUE(tuc::string::starts_with("abc", "ab"));
         EXPECT_TRUE(tuc::string::starts_with("abc", "abc"));
@@ -38,4 +60,272 @@ namespace {
         EXPECT_FALSE(tuc::string::equal_case_insensitive("abc", "bC"));
 #endif // WIN32
     }
+
+    TEST_F(StringTest, ReplacesAll) {
+        std::string text = "a-b-c";
+        EXPECT_EQ(tuc::string::replace_all(text, "-", "--"), 2u);
+        EXPECT_EQ(text, "a--b--c");
+        EXPECT_EQ(tuc::string::replace_all(text, "--", "+"), 2u);
+        EXPECT_EQ(text, "a+b+c");
+        EXPECT_EQ(tuc::string::replace_all(text, "+", "*"), 2u);
+        EXPECT_EQ(text, "a*b*c");
+        EXPECT_EQ(tuc::string::replace_all(text, "", "x"), 0u);
+        std::wstring wide = L"aaaaa";
+        EXPECT_EQ(tuc::wstring::replace_all(wide, L"aa", L"b"), 2u);
+        EXPECT_EQ(wide, L"bba");
+
+        std::string document = "Dear {name}, your order {order} has shipped. {unknown} {name}!";
+        EXPECT_EQ(tuc::string::replace_all(document, { { "{name}", "Alice" }, { "{order}", "#42" }, { "{", "{{" } }), 4u);
+        EXPECT_EQ(document, "Dear Alice, your order #42 has shipped. {{unknown} Alice!");
+
+        // Compare to a straightforward implementation: at each position, replace the longest match
+        std::vector<std::pair<std::string_view, std::string_view>> const replacements = {
+            { "a", "1" }, { "ab", "22" }, { "abc", "" }, { "bc", "4444" }, { "ca", "5" }, { "cab", "66" }, { "b", "7" }, { "ab", "duplicate" }
+        };
+        tuc::string::replacer const replacer(replacements);
+        std::mt19937 generator(42);
+        std::uniform_int_distribution<int> distribution('a', 'd');
+        for (int i = 0; i < 100; ++i) {
+            std::string input(i, ' ');
+            for (char& c : input) {
+                c = static_cast<char>(distribution(generator));
+            }
+            std::string expected;
+            size_t expected_count = 0;
+            for (size_t position = 0; position < input.size(); ) {
+                size_t longest = replacements.size();
+                for (size_t j = 0; j < replacements.size(); ++j) {
+                    auto const& before = replacements[j].first;
+                    if (input.compare(position, before.size(), before) == 0 && (longest == replacements.size() || before.size() > replacements[longest].first.size())) {
+                        longest = j;
+                    }
+                }
+                if (longest < replacements.size()) {
+                    expected += replacements[longest].second;
+                    position += replacements[longest].first.size();
+                    ++expected_count;
+                }
+                else {
+                    expected += input[position++];
+                }
+            }
+            EXPECT_EQ(replacer.replace_all(input), expected_count);
+            EXPECT_EQ(input, expected);
+        }
+    }
+
+    TEST_F(StringTest, SplitsAndJoins) {
+        auto const to_vector = [](auto const& range) {
+            return std::vector<std::string>(range.begin(), range.end());
+        };
+
+        EXPECT_EQ(to_vector(tuc::string::split("a,b,,c,", ',')), std::vector<std::string>({ "a", "b", "", "c", "" }));
+        EXPECT_EQ(to_vector(tuc::string::split("", ',')), std::vector<std::string>({ "" }));
+        EXPECT_EQ(to_vector(tuc::string::split("a::b:c", "::")), std::vector<std::string>({ "a", "b:c" }));
+        EXPECT_EQ(to_vector(tuc::string::split("abc", "")), std::vector<std::string>({ "abc" }));
+        EXPECT_EQ(to_vector(tuc::string::tokenize("  a \tb\n\nc ")), std::vector<std::string>({ "a", "b", "c" }));
+        EXPECT_EQ(to_vector(tuc::string::tokenize(" \t ")), std::vector<std::string>());
+
+        std::vector<std::wstring> wide;
+        for (auto const token : tuc::wstring::split_any_of(L"a;b,c", L",;")) {
+            wide.emplace_back(token);
+        }
+        EXPECT_EQ(wide, std::vector<std::wstring>({ L"a", L"b", L"c" }));
+
+        // Long enough for the vectorized search, with delimiters at various positions
+        std::string line;
+        std::vector<std::string> fields;
+        for (int i = 0; i < 50; ++i) {
+            fields.push_back(std::string(i % 37, static_cast<char>('a' + i % 26)));
+            line += fields.back() + (i % 3 == 0 ? "," : i % 3 == 1 ? ";" : "\t");
+        }
+        fields.push_back("");
+
+        auto& selected_instruction_set = tuc::simd_detail::selected_instruction_set();
+        auto const original_instruction_set = selected_instruction_set;
+
+        for (auto const instruction_set : { tuc::simd_detail::instruction_set::scalar, tuc::simd_detail::instruction_set::sse2, tuc::simd_detail::instruction_set::avx2, tuc::simd_detail::instruction_set::neon }) {
+            if (!tuc::simd_detail::is_supported(instruction_set)) {
+                continue;
+            }
+            selected_instruction_set = instruction_set;
+            EXPECT_EQ(to_vector(tuc::string::split_any_of(line, ",;\t")), fields);
+            EXPECT_EQ(to_vector(tuc::string::split_any_of(line, "\x01\x02\x03\x04\x05\x06\x07\x08\x0b\x0c\x0e\x0f\x10\x11\x12\x13\x14,;\t")), fields); // too many for SIMD
+        }
+
+        selected_instruction_set = original_instruction_set;
+
+        EXPECT_EQ(tuc::string::join(fields, "\t"), tuc::string::join(tuc::string::split_any_of(line, ",;\t"), "\t"));
+        EXPECT_EQ(tuc::string::join(std::vector<std::string_view>({ "", "a", "" }), ", "), ", a, ");
+        EXPECT_EQ(tuc::string::join(std::vector<std::string>(), ", "), "");
+        EXPECT_EQ(tuc::wstring::join(std::vector<wchar_t const*>({ L"a", L"b" }), L"/"), L"a/b");
+    }
+
+    TEST_F(StringTest, SearchesSubstrings) {
+        // A small alphabet, so that partial matches are frequent
+        std::mt19937 random(7);
+        std::uniform_int_distribution<int> letter('a', 'c');
+        std::string haystack(1000, ' ');
+        for (char& c : haystack) {
+            c = static_cast<char>(letter(random));
+        }
+
+        auto& selected_instruction_set = tuc::simd_detail::selected_instruction_set();
+        auto const original_instruction_set = selected_instruction_set;
+
+        for (auto const instruction_set : { tuc::simd_detail::instruction_set::scalar, tuc::simd_detail::instruction_set::sse2, tuc::simd_detail::instruction_set::avx2, tuc::simd_detail::instruction_set::neon }) {
+            if (!tuc::simd_detail::is_supported(instruction_set)) {
+                continue;
+            }
+            selected_instruction_set = instruction_set;
+            for (size_t needle_length = 0; needle_length <= 12; ++needle_length) {
+                for (size_t needle_position : { size_t(0), size_t(500), haystack.length() - needle_length }) {
+                    std::string const needle = haystack.substr(needle_position, needle_length);
+                    tuc::string::searcher const searcher(needle);
+                    for (size_t from : { size_t(0), size_t(1), size_t(499), size_t(990), haystack.length(), haystack.length() + 1 }) {
+                        EXPECT_EQ(searcher.find(haystack, from), haystack.find(needle, from));
+                    }
+                }
+            }
+            tuc::string::searcher const absent("abcabcabcabc_");
+            EXPECT_EQ(absent.find(haystack), std::string::npos);
+            EXPECT_FALSE(absent.contains(haystack));
+        }
+
+        selected_instruction_set = original_instruction_set;
+
+        tuc::wstring::searcher const wide(L"\u0101b");
+        EXPECT_EQ(wide.find(L"ab\u0101\u0101b"), 3);
+        EXPECT_EQ(wide.find(L"ab\u0101\u0100b"), std::wstring::npos);
+    }
+
+    TEST_F(StringTest, SearchesForManyNeedles) {
+        std::string const log = std::string(100, '.') + "INFO: ok; WARN: disk; ERROR: fail";
+
+        EXPECT_EQ(tuc::string::find_first_of_many(log, { "ERROR", "WARN", "FATAL" }), std::make_pair(size_t(110), size_t(1)));
+        EXPECT_TRUE(tuc::string::contains_any(log, { "FATAL", "ERROR" }));
+        EXPECT_FALSE(tuc::string::contains_any(log, { "FATAL", "" }));
+        EXPECT_EQ(tuc::string::find_first_of_many(log, { "INFO", "INFO: ok" }), std::make_pair(size_t(100), size_t(1))); // the longest one
+        EXPECT_EQ(tuc::string::find_first_of_many("", { "a" }), std::make_pair(std::string::npos, std::string::npos));
+
+        tuc::string::multi_searcher const searcher({ "WARN", "ERROR" });
+        EXPECT_EQ(searcher.find_first(log, 111), std::make_pair(size_t(122), size_t(1)));
+        EXPECT_EQ(searcher.find_first(log, 123), std::make_pair(std::string::npos, std::string::npos));
+
+        EXPECT_EQ(tuc::wstring::find_first_of_many(L"xxbxa", { L"a", L"b" }), std::make_pair(size_t(2), size_t(1)));
+    }
+
+    TEST_F(StringTest, MatchesManyPrefixesAndSuffixes) {
+        tuc::string::prefix_matcher const routes({ "/api/", "/api/v1/", "/static/", "/", "/api/v1/" });
+        EXPECT_EQ(routes.find_longest("/api/v1/users"), 1u);
+        EXPECT_EQ(routes.find_longest("/api/v2/users"), 0u);
+        EXPECT_EQ(routes.find_longest("/index.html"), 3u);
+        EXPECT_EQ(routes.find_longest("api"), tuc::string::prefix_matcher::npos);
+        EXPECT_EQ(routes.find_all("/api/v1/users"), std::vector<size_t>({ 3, 0, 1 })); // the duplicate is not returned
+        EXPECT_FALSE(routes.matches_any(""));
+
+        tuc::string::suffix_matcher const extensions({ ".gz", ".tar.gz", ".JPG", "" }, tuc::case_sensitivity::case_insensitive);
+        EXPECT_EQ(extensions.find_longest("backup.TAR.GZ"), 1u);
+        EXPECT_EQ(extensions.find_longest("photo.jpg"), 2u);
+        EXPECT_EQ(extensions.find_longest("notes.txt"), 3u); // the empty suffix
+        EXPECT_EQ(extensions.find_all("a.tar.gz"), std::vector<size_t>({ 3, 0, 1 }));
+
+        tuc::string::suffix_matcher const case_sensitive({ ".JPG" });
+        EXPECT_FALSE(case_sensitive.matches_any("photo.jpg"));
+        EXPECT_TRUE(case_sensitive.matches_any("photo.JPG"));
+
+        tuc::wstring::prefix_matcher const wide({ L"\u00C4b", L"x" }, tuc::case_sensitivity::case_insensitive);
+        EXPECT_EQ(wide.find_longest(L"\u00E4Bc"), 0u);
+    }
+
+    TEST_F(StringTest, TranscodesUtf) {
+        // Runs of ASCII of various lengths, between code points of each UTF-8 length
+        std::mt19937 random(11);
+        std::u32string utf32;
+        for (int i = 0; i < 200; ++i) {
+            utf32.append(random() % 40, U'a' + static_cast<char32_t>(i % 26));
+            char32_t const others[] = { U'\u00E9', U'\u20AC', U'\U0001F600', U'\uFFFF', U'\U0010FFFF' };
+            utf32 += others[random() % 5];
+        }
+
+        auto& selected_instruction_set = tuc::simd_detail::selected_instruction_set();
+        auto const original_instruction_set = selected_instruction_set;
+
+        for (auto const instruction_set : { tuc::simd_detail::instruction_set::scalar, tuc::simd_detail::instruction_set::sse2, tuc::simd_detail::instruction_set::avx2, tuc::simd_detail::instruction_set::neon }) {
+            if (!tuc::simd_detail::is_supported(instruction_set)) {
+                continue;
+            }
+            selected_instruction_set = instruction_set;
+            std::string const utf8 = tuc::generic_string::to_utf8(utf32);
+            EXPECT_TRUE(tuc::string::is_valid_utf8(utf8));
+            EXPECT_TRUE(tuc::generic_string::from_utf8<char32_t>(utf8) == utf32);
+            std::u16string const utf16 = tuc::generic_string::from_utf8<char16_t>(utf8);
+            EXPECT_EQ(tuc::generic_string::to_utf8(utf16), utf8);
+            EXPECT_EQ(tuc::wstring::to_string(tuc::string::to_wstring(utf8)), utf8);
+            EXPECT_FALSE(tuc::string::is_valid_utf8(utf8 + "\xF4\x90\x80\x80")); // over U+10FFFF
+        }
+
+        selected_instruction_set = original_instruction_set;
+
+        EXPECT_EQ(tuc::string::to_wstring("a\xC3\xA9\xE2\x82\xAC"), L"a\u00E9\u20AC");
+        EXPECT_EQ(tuc::string::to_wstring("\xC0\x80|\xE2\x82|\xED\xA0\x80", tuc::invalid_sequence_policy::replace), L"\uFFFD\uFFFD|\uFFFD|\uFFFD\uFFFD\uFFFD");
+        EXPECT_EQ(tuc::generic_string::to_utf8(std::u16string(u"a\xD800" u"b"), tuc::invalid_sequence_policy::replace), "a\xEF\xBF\xBD" "b");
+        try {
+            tuc::string::to_wstring("abc\xFF");
+            EXPECT_TRUE(false);
+        }
+        catch (std::range_error const&) {
+        }
+    }
+
+    TEST_F(StringTest, FoldsUnicodeCase) {
+        EXPECT_TRUE(tuc::wstring::equal_case_insensitive(L"\u00C4\u0416\u03A3\u03A3", L"\u00E4\u0436\u03C3\u03C2")); // including the final sigma
+        EXPECT_TRUE(tuc::wstring::equal_case_insensitive(L"\u212A\u0100\u01C5", L"k\u0101\u01C6"));
+        EXPECT_FALSE(tuc::wstring::equal_case_insensitive(L"\u0131", L"I")); // dotless i folds only in Turkish
+        EXPECT_FALSE(tuc::wstring::equal_case_insensitive(L"\u0100", L"\u0102"));
+
+        std::unordered_map<std::wstring, int, tuc::wstring::case_insensitive_hash, tuc::wstring::case_insensitive_equal> wide;
+        wide[L"\u0393\u03B5\u03B9\u03AC"] = 1;
+        EXPECT_EQ(wide.count(L"\u0393\u0395\u0399\u0386"), 1u);
+    }
+
+    TEST_F(StringTest, ComparesAndHashesLongStringsCaseInsensitively) {
+        std::string const lower = "content-type: text/html; charset=utf-8 \x80\xff [@`{] and then some more to exceed a vector or two";
+        std::string upper = lower;
+        std::transform(upper.begin(), upper.end(), upper.begin(), [](char c) { return c >= 'a' && c <= 'z' ? static_cast<char>(c - 32) : c; });
+
+        auto& selected_instruction_set = tuc::simd_detail::selected_instruction_set();
+        auto const original_instruction_set = selected_instruction_set;
+
+        for (auto const instruction_set : { tuc::simd_detail::instruction_set::scalar, tuc::simd_detail::instruction_set::sse2, tuc::simd_detail::instruction_set::avx2, tuc::simd_detail::instruction_set::neon }) {
+            if (!tuc::simd_detail::is_supported(instruction_set)) {
+                continue;
+            }
+            selected_instruction_set = instruction_set;
+
+            EXPECT_TRUE(tuc::string::equal_case_insensitive(lower, upper));
+            EXPECT_EQ(tuc::string::case_insensitive_hash()(lower), tuc::string::case_insensitive_hash()(upper));
+            for (size_t i = 0; i < lower.size(); ++i) {
+                for (char const c : { '@', '[', '`', '{', '\x7f', '\xc4' }) {
+                    if (upper[i] != c) {
+                        std::string different = upper;
+                        different[i] = c;
+                        EXPECT_FALSE(tuc::string::equal_case_insensitive(lower, different));
+                    }
+                }
+            }
+        }
+
+        selected_instruction_set = original_instruction_set;
+
+        std::unordered_map<std::string, int, tuc::string::case_insensitive_hash, tuc::string::case_insensitive_equal> headers;
+        headers["Content-Length"] = 42;
+        EXPECT_EQ(headers.count("content-length"), 1u);
+        EXPECT_EQ(headers["CONTENT-LENGTH"], 42);
+        EXPECT_EQ(headers.count("content-type"), 0u);
+
+        std::unordered_map<std::wstring, int, tuc::wstring::case_insensitive_hash, tuc::wstring::case_insensitive_equal> wide;
+        wide[L"Key"] = 1;
+        EXPECT_EQ(wide.count(L"kEY"), 1u);
+    }
 }  // namespace
@@ -0,0 +1,75 @@
+struct IUnknown; // Workaround for "combaseapi.h(229): error C2187: syntax error: 'identifier' was unexpected here" when using /permissive-
+
+#include "../include/tuc/string_pool.hpp"
+#include "picotest/picotest.h"
+#include <string>
+#include <thread>
+#include <unordered_map>
+
+namespace {
+
+    class StringPoolTest : public ::testing::Test {
+    };
+
+    TEST_F(StringPoolTest, InternsEachStringOnce) {
+        tuc::string_pool pool(64);
+
+        std::string const label = "person";
+        std::string_view const first = pool.intern(label);
+        std::string_view const second = pool.intern(std::string("per") + "son");
+        EXPECT_EQ(first.data(), second.data());
+        EXPECT_NE(first.data(), label.data());
+        EXPECT_EQ(first, "person");
+        EXPECT_EQ(first.data()[first.length()], '\0');
+        EXPECT_NE(pool.intern("car").data(), first.data());
+
+        // The views remain valid as the pool grows, also with long strings
+        for (int i = 0; i < 1000; ++i) {
+            pool.intern(std::to_string(i));
+        }
+        std::string const long_string(1000, 'x');
+        std::string_view const long_view = pool.intern(long_string);
+        EXPECT_EQ(pool.intern("person").data(), first.data());
+        EXPECT_EQ(first, "person");
+        EXPECT_EQ(long_view, long_string);
+        EXPECT_EQ(pool.get_size(), 1003u);
+
+        EXPECT_EQ(pool.find("truck").data(), nullptr);
+        EXPECT_EQ(pool.find("car"), "car");
+        EXPECT_NE(pool.intern("").data(), nullptr);
+
+        std::unordered_map<std::string_view, int, tuc::string_pool::pointer_hash, tuc::string_pool::pointer_equal> counts;
+        ++counts[pool.intern("car")];
+        ++counts[pool.intern(std::string("car"))];
+        EXPECT_EQ(counts.size(), 1u);
+        EXPECT_EQ(counts[pool.find("car")], 2);
+    }
+
+    TEST_F(StringPoolTest, InternsConcurrently) {
+        tuc::concurrent_string_pool pool(8);
+        size_t constexpr thread_count = 4;
+        size_t constexpr string_count = 2000;
+
+        std::vector<std::vector<std::string_view>> results(thread_count);
+        std::vector<std::thread> threads;
+        for (size_t t = 0; t < thread_count; ++t) {
+            threads.emplace_back([&, t]() {
+                for (size_t i = 0; i < string_count; ++i) {
+                    results[t].push_back(pool.intern("label-" + std::to_string((i * (t + 1)) % string_count)));
+                }
+            });
+        }
+        for (auto& thread : threads) {
+            thread.join();
+        }
+
+        EXPECT_EQ(pool.get_size(), string_count);
+        for (size_t t = 0; t < thread_count; ++t) {
+            for (size_t i = 0; i < string_count; ++i) {
+                std::string const expected = "label-" + std::to_string((i * (t + 1)) % string_count);
+                EXPECT_EQ(results[t][i], expected);
+                EXPECT_EQ(results[t][i].data(), pool.find(expected).data());
+            }
+        }
+    }
+}  // namespace
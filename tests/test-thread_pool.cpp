@@ -287,6 +287,89 @@ namespace {
         }
     }
 
+    TEST_F(ThreadPoolTest, ScansInParallel) {
+        tuc::thread_pool tp(4);
+
+        std::vector<int32_t> input(100003);
+        std::iota(input.begin(), input.end(), -50000);
+        std::vector<int32_t> expected(input.size()), actual(input.size());
+
+        auto& selected_instruction_set = tuc::simd_detail::selected_instruction_set();
+        auto const original_instruction_set = selected_instruction_set;
+
+        for (auto const instruction_set : { tuc::simd_detail::instruction_set::scalar, tuc::simd_detail::instruction_set::sse2, tuc::simd_detail::instruction_set::avx2, tuc::simd_detail::instruction_set::neon }) {
+            if (!tuc::simd_detail::is_supported(instruction_set)) {
+                continue;
+            }
+            selected_instruction_set = instruction_set;
+
+            std::inclusive_scan(input.begin(), input.end(), expected.begin());
+            EXPECT_EQ(tuc::inclusive_scan(tp, input.begin(), input.end(), actual.begin()), actual.end());
+            EXPECT_EQ(actual, expected);
+
+            std::exclusive_scan(input.begin(), input.end(), expected.begin(), 7);
+            actual = input;
+            tuc::exclusive_scan(tp, actual.data(), actual.data() + actual.size(), actual.data(), 7); // in place
+            EXPECT_EQ(actual, expected);
+
+            std::vector<uint64_t> const sizes(input.begin(), input.end());
+            std::vector<uint64_t> expected_offsets(sizes.size()), offsets(sizes.size());
+            std::exclusive_scan(sizes.begin(), sizes.end(), expected_offsets.begin(), uint64_t(0));
+            tuc::exclusive_scan(tp, sizes.begin(), sizes.end(), offsets.begin(), uint64_t(0));
+            EXPECT_EQ(offsets, expected_offsets);
+
+            std::vector<int32_t> const small = { 1, 2, 3 };
+            std::vector<int32_t> small_output(small.size());
+            tuc::inclusive_scan(tp, small.begin(), small.end(), small_output.begin());
+            EXPECT_EQ(small_output, std::vector<int32_t>({ 1, 3, 6 }));
+        }
+
+        selected_instruction_set = original_instruction_set;
+
+        // An associative, but not commutative, operation: composition of affine functions f(x) = ax + b
+        using affine = std::pair<uint32_t, uint32_t>;
+        auto const compose = [](affine const& f, affine const& g) { // first f, then g
+            return affine(g.first * f.first, g.first * f.second + g.second);
+        };
+        std::vector<affine> functions(input.size());
+        for (size_t i = 0; i < functions.size(); ++i) {
+            functions[i] = affine(static_cast<uint32_t>(i % 7 + 1), static_cast<uint32_t>(i));
+        }
+        std::vector<affine> expected_compositions(functions.size()), compositions(functions.size());
+        std::inclusive_scan(functions.begin(), functions.end(), expected_compositions.begin(), compose);
+        tuc::inclusive_scan(tp, functions.begin(), functions.end(), compositions.begin(), compose);
+        EXPECT_EQ(compositions, expected_compositions);
+    }
+
+    TEST_F(ThreadPoolTest, ScansPropagateExceptionsAfterAllTasksFinish) {
+        tuc::thread_pool tp(4);
+        std::vector<int64_t> input(1 << 18, 1), output(input.size());
+        input[1] = -1; // fails in the first block
+        input[input.size() / 2 + 1] = 2; // while another block is still busy
+        std::atomic<int> running{ 0 };
+        auto const throwing_plus = [&running](int64_t lhs, int64_t rhs) {
+            if (rhs < 0) {
+                for (int i = 0; i < 1000 && running == 0; ++i) { // fail only once the other block is busy
+                    std::this_thread::sleep_for(std::chrono::milliseconds(1));
+                }
+                throw std::runtime_error("negative");
+            }
+            if (rhs == 2) {
+                ++running;
+                std::this_thread::sleep_for(std::chrono::milliseconds(50));
+                --running;
+            }
+            return lhs + rhs;
+        };
+        try {
+            tuc::inclusive_scan(tp, input.begin(), input.end(), output.begin(), throwing_plus);
+            EXPECT_TRUE(false);
+        }
+        catch (std::runtime_error&) {
+            EXPECT_EQ(running, 0); // the tasks refer to the locals of the scan, so they must be done
+        }
+    }
+
     TEST_F(ThreadPoolTest, ChangesThreadPoolSize) {
         tuc::thread_pool tp;
         EXPECT_EQ(tp.get_thread_count(), std::thread::hardware_concurrency());
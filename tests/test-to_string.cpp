@@ -2,6 +2,7 @@ struct IUnknown; // Workaround for "combaseapi.h(229): error C2187: syntax error
 
 #include "../include/tuc/to_string.hpp"
 #include "picotest/picotest.h"
+#include <vector>
 
 namespace {
 
@@ -56,4 +57,36 @@ namespace {
         EXPECT_EQ("42.857", tuc::to_percentage_string(33333, 77777));
         EXPECT_EQ("42.858", tuc::to_percentage_string(33334, 77777));
     }
+
+    TEST_F(ToStringTest, FormatsIntoBuffersAndStrings) {
+        char buffer[8];
+        auto const result = tuc::to_chars(buffer, buffer + sizeof(buffer), 9.9999, 3);
+        EXPECT_TRUE(result.ec == std::errc());
+        EXPECT_EQ("10.0", std::string(buffer, result.ptr));
+        EXPECT_TRUE(tuc::to_chars(buffer, buffer + sizeof(buffer), 12345678.9, 2).ec == std::errc::value_too_large);
+
+        auto const percentage = tuc::to_percentage_chars(buffer, buffer + sizeof(buffer), 33333, 77777);
+        EXPECT_EQ("42.857", std::string(buffer, percentage.ptr));
+
+        std::string output = "x=";
+        tuc::append_to_string(output, 0.0001226, 3);
+        output += ", y=";
+        tuc::append_percentage_string(output, 9, 1000);
+        EXPECT_EQ("x=0.000123, y=0.9", output);
+
+        EXPECT_EQ("0.0", tuc::to_string(0.0, 3));
+        EXPECT_EQ("0", tuc::to_string(0.0, 4, 0));
+        EXPECT_EQ(103, tuc::to_string(1e100, 3).length()); // longer than the buffer on the stack
+    }
+
+    TEST_F(ToStringTest, FormatsColumns) {
+        std::vector<double> const column = { 1.0, 9.9999, 0.0001234 };
+        std::string output;
+        tuc::append_to_string(output, column.begin(), column.end(), "\n", 3);
+        EXPECT_EQ("1.00\n10.0\n0.000123", output);
+
+        output.clear();
+        tuc::append_to_string(output, column.begin(), column.begin(), "\n", 3);
+        EXPECT_EQ("", output);
+    }
 }  // namespace